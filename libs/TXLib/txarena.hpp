@@ -0,0 +1,59 @@
+// Copyright@TXLib All rights reserved.
+// Author: TX Studio: TX_Jerry
+// File: TXLib_Arena
+
+#pragma once
+#include "txlib.hpp"
+
+namespace tx {
+
+	// Bump allocator for data that lives one frame or one tick, used through std::pmr containers:
+	//     std::pmr::vector<int> v{ arena.resource() };
+	// Allocating moves a pointer, deallocating does nothing, and reset() frees everything at once.
+	// Allocations beyond the buffer go to the heap; the next reset() grows the buffer by that much,
+	// so a steady workload soon runs without touching the heap at all.
+	// Containers using the arena must be gone before reset(). One thread only.
+	class BumpArena {
+	public:
+		explicit BumpArena(size_t initialSize = 64 * 1024) :
+			buffer(initialSize),
+			bump(std::in_place, buffer.data(), buffer.size(), &spill)
+		{}
+		BumpArena(const BumpArena&) = delete;
+		BumpArena& operator=(const BumpArena&) = delete;
+
+		inline std::pmr::memory_resource* resource() { return &*this->bump; }
+
+		void reset() {
+			this->bump->release();
+			size_t spilled = this->spill.take();
+			if (spilled == 0) return;
+			this->buffer.resize(this->buffer.size() + spilled);
+			this->bump.emplace(this->buffer.data(), this->buffer.size(), &this->spill);
+		}
+
+		inline size_t capacity() const { return this->buffer.size(); }
+
+	private:
+		// heap fallback that counts what the buffer could not hold
+		class SpillResource : public std::pmr::memory_resource {
+		public:
+			inline size_t take() { return std::exchange(this->spilled, 0); }
+		private:
+			size_t spilled = 0;
+			void* do_allocate(size_t bytes, size_t alignment) override {
+				this->spilled += bytes;
+				return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+			}
+			void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+				std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+			}
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+		};
+
+		vector<std::byte> buffer;
+		SpillResource spill;
+		std::optional<std::pmr::monotonic_buffer_resource> bump;
+	};
+
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "txlib.hpp"
+#include "txjob.hpp"
 #include "GLFW/glfw3.h"
 
 // txglib ************************************************************************************************************** TXGLib
@@ -200,7 +201,8 @@ namespace tx {
 	namespace RenderEngine {
 		enum class Mode {
 			Debug = 0,
-			Release = 1
+			Release = 1,
+			Threaded = 2	// fixed tickrate on a simulation thread of its own, the main thread only renders
 		};
 
 		class InitGLFW {
@@ -339,7 +341,7 @@ namespace tx {
 				MaxAccumulatorTime(TickIntervalTime* in_MaxAccumulatorMultiplier)
 			{
 				static_assert(std::is_invocable_v<U> || std::is_invocable_v<U, int>, "Update callback must have (int) or () as parameter. The provided callable was invalid.");
-				static_assert(std::is_invocable_v<R>, "Render call back must have no parameter. The provided callable was invalid.");
+				static_assert(std::is_invocable_v<R> || std::is_invocable_v<R, float>, "Render callback must have (float) or () as parameter. The provided callable was invalid.");
 				this->valid = in_initGLFW(this->window);
 			}
 
@@ -348,49 +350,87 @@ namespace tx {
 				//timeBeginPeriod(1);
 				std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
 				double accumulator = 0.0;
+				float alpha = 1.0f;	// share of the next tick already elapsed, passed to a render callback taking (float)
 				//cout << "main loop started\n";
 				if(!this->window){
 					cout << "[FatalError]: Invalid window token.\n";
 					return;
 				}
 				cout << this->window << '\n';
+				std::atomic<bool> simulating{ true };
+				std::thread simulation;
+				if constexpr (mode == Mode::Threaded) {
+					simulation = std::thread([this, &simulating]() { this->simulate_impl(simulating); });
+				}
 				while (!glfwWindowShouldClose(this->window)) {
 					//cout << "iteration started\n";
+					bool warping = this->timeWarp.load(std::memory_order_relaxed);
 					if constexpr (mode == Mode::Release) {
 						std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 						double tick_duration = std::chrono::duration<double>(now - last).count();
 						accumulator += tick_duration;
 						last = now;
-						if (accumulator > this->MaxAccumulatorTime) accumulator = this->MaxAccumulatorTime;
-						while (accumulator >= this->TickIntervalTime) {
+						if (warping) {
+							this->warpTicks_impl();
+							accumulator = 0.0;
+							alpha = 1.0f;
+						}
+						else {
+							if (accumulator > this->MaxAccumulatorTime) accumulator = this->MaxAccumulatorTime;
+							while (accumulator >= this->TickIntervalTime) {
+								this->callUpdateCallback(this->tickCounter);
+
+								this->tickCounter++;
+								accumulator -= this->TickIntervalTime;
+							}
+							alpha = static_cast<float>(accumulator / this->TickIntervalTime);
+						}
+					}
+					else if constexpr (mode == Mode::Debug) {
+						if (warping) {
+							this->warpTicks_impl();
+						}
+						else {
 							this->callUpdateCallback(this->tickCounter);
-
 							this->tickCounter++;
-							accumulator -= this->TickIntervalTime;
 						}
 					}
 					else {
-						this->callUpdateCallback(this->tickCounter);
-						this->tickCounter++;
+						double sinceTick = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count() - this->lastTickTime.load(std::memory_order_relaxed);
+						alpha = static_cast<float>(std::clamp(sinceTick / this->TickIntervalTime, 0.0, 1.0));
 					}
 					//cout << "render starts\n";
 
+					// while warping only one frame per WarpRenderInterval is drawn, events are still polled every pass
+					double sinceRender = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->lastRender).count();
+					if (!warping || sinceRender >= this->WarpRenderInterval) {
+						this->lastRender = std::chrono::steady_clock::now();
+						//glClearColor(0.80f, 9.0f, 1.0f, 1.0f);
+						glClear(GL_COLOR_BUFFER_BIT);
+						// render start
+						glBegin(GL_TRIANGLES);
 
-					
-					//glClearColor(0.80f, 9.0f, 1.0f, 1.0f);
-					glClear(GL_COLOR_BUFFER_BIT);
-					// render start
-					glBegin(GL_TRIANGLES);
+						this->callRenderCallback(alpha);
 
-					this->renderCb();
+						// render end
+						glEnd();
 
-					// render end
-					glEnd();
+						//cout << "swap buffer start\n";
+						glfwSwapBuffers(this->window);
+						glfwPollEvents();
+					}
+					else if constexpr (mode == Mode::Threaded) {
+						// nothing to draw yet: wait for input instead of spinning, the simulation thread gets the core
+						glfwWaitEventsTimeout((this->WarpRenderInterval - sinceRender) / 1000.0);
+					}
+					else {
+						glfwPollEvents();
+					}
 
-					//cout << "swap buffer start\n";
-					glfwSwapBuffers(this->window);
-					glfwPollEvents();
+					this->background.run(this->BackgroundBudget);
 				}
+				simulating = false;
+				if (simulation.joinable()) simulation.join();
 			}
 			~Framework() {
 				if (valid) {
@@ -401,6 +441,22 @@ namespace tx {
 			}
 
 			inline GLFWwindow* getWindow() { return this->window; }
+			// deferred work, run on the main thread after every frame within BackgroundBudget
+			inline BackgroundScheduler& getBackground() { return this->background; }
+			inline void setBackgroundBudget(double in_BackgroundBudget) { this->BackgroundBudget = in_BackgroundBudget; }
+			// Time warp: as many ticks as the CPU allows instead of the fixed tickrate, frames thinned out
+			// to one per WarpRenderInterval. Release and Debug tick for WarpFrameBudget between two event
+			// polls, Threaded ticks back to back on its own thread. Callable while running.
+			inline void setTimeWarp(bool in_timeWarp) { this->timeWarp.store(in_timeWarp, std::memory_order_relaxed); }
+			inline bool getTimeWarp() const { return this->timeWarp.load(std::memory_order_relaxed); }
+			inline void setWarpRenderInterval(double in_WarpRenderInterval) { this->WarpRenderInterval = in_WarpRenderInterval; }
+			// before run()
+			void setFixedTickrate(double in_FixedTickrate) {
+				double maxAccumulatorMultiplier = this->MaxAccumulatorTime / this->TickIntervalTime;
+				this->FixedTickrate = in_FixedTickrate;
+				this->TickIntervalTime = 1.0 / in_FixedTickrate;
+				this->MaxAccumulatorTime = this->TickIntervalTime * maxAccumulatorMultiplier;
+			}
 
 		private:
 			GLFWwindow* window;
@@ -409,9 +465,58 @@ namespace tx {
 			double FixedTickrate = 60.0;
 			double TickIntervalTime; // seconds
 			double MaxAccumulatorTime;
+			double BackgroundBudget = 2.0;	// ms per frame
+			BackgroundScheduler background;
+			std::atomic<bool> timeWarp{ false };
+			double WarpFrameBudget = 10.0;		// ms of ticks between two event polls while warping (Release, Debug)
+			double WarpRenderInterval = 100.0;	// ms between frames drawn while warping
+			std::chrono::steady_clock::time_point lastRender{};
 
 			int tickCounter = 0;
 			bool valid = 1;
+			std::atomic<double> lastTickTime{ 0.0 };	// Mode::Threaded: steady clock seconds when the last tick finished
+
+			// Mode::Release / Debug while warping: ticks back to back for WarpFrameBudget, at least once
+			void warpTicks_impl() {
+				using Clock = std::chrono::steady_clock;
+				Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(this->WarpFrameBudget));
+				do {
+					this->callUpdateCallback(this->tickCounter);
+					this->tickCounter++;
+				} while (Clock::now() < end);
+			}
+
+			// Mode::Threaded: ticks at the fixed tickrate until simulating is cleared.
+			// A backlog beyond MaxAccumulatorTime is dropped instead of caught up, as in Release.
+			// While warping it does not sleep between ticks.
+			void simulate_impl(const std::atomic<bool>& simulating) {
+				using Clock = std::chrono::steady_clock;
+				const Clock::duration interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(this->TickIntervalTime));
+				const Clock::duration maxBacklog = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(this->MaxAccumulatorTime));
+				Clock::time_point next = Clock::now();
+				while (simulating.load(std::memory_order_relaxed)) {
+					this->callUpdateCallback(this->tickCounter);
+					this->tickCounter++;
+					this->lastTickTime.store(std::chrono::duration<double>(Clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+					next += interval;
+					Clock::time_point now = Clock::now();
+					if (this->timeWarp.load(std::memory_order_relaxed)) {
+						next = now;
+						continue;
+					}
+					if (now - next > maxBacklog) next = now;
+					std::this_thread::sleep_until(next);
+				}
+			}
+
+			inline void callRenderCallback(float alpha) {
+				if constexpr (std::is_invocable_v<RenderCallback, float>) {
+					this->renderCb(alpha);
+				}
+				else {
+					this->renderCb();
+				}
+			}
 
 			inline void callUpdateCallback(int tickCounter) {
 				if constexpr (std::is_invocable_v<UpdateCallback, int>) {
@@ -445,6 +550,17 @@ namespace tx {
 				in_MaxAccumulatorMultiplier
 			);
 		}
+		template<class UF, class RF>
+		static inline auto CreateThreaded(UF&& ucb, RF&& rcb,
+			double in_FixedTickrate = 60.0,
+			double in_MaxAccumulatorMultiplier = 5.0) {
+			return Framework<Mode::Threaded, UF, RF>(
+				std::forward<UF>(ucb),
+				std::forward<RF>(rcb),
+				in_FixedTickrate,
+				in_MaxAccumulatorMultiplier
+			);
+		}
 
 
 
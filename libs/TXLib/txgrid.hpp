@@ -0,0 +1,204 @@
+// Copyright@TXLib All rights reserved.
+// Author: TX Studio: TX_Jerry
+// File: TXLib_Grid
+
+#pragma once
+#include "txlib.hpp"
+
+// Grid containers and rasterised shapes, kept free of any graphics dependency
+
+namespace tx {
+
+	// all bitmap should be sorted
+	using Bitmap = vector<Coord>;
+	inline void sortBitmap(Bitmap& map) {
+		std::sort(map.begin(), map.end(), [](const Coord& a, const Coord& b) {
+				if (a.y() == b.y()) {
+					return a.x() < b.x();
+				} else {
+					return a.y() < b.y();
+				}
+			});
+		auto it = std::unique(map.begin(), map.end());
+		map.erase(it, map.end());
+	}
+	inline void clampBitmap(Bitmap& map, const Coord& bottomLeft, const Coord& topRight){
+		map.erase(std::remove_if(map.begin(), map.end(), [&](const Coord& in) {
+			return tx::inRange(in, bottomLeft, topRight);
+		}));
+	}
+
+	template<class T>
+	class GridSystem {
+	public:
+		GridSystem() {}
+		GridSystem(int in_SideLen) :
+			Width(in_SideLen), Height(in_SideLen)
+		{
+			this->map.assign(tx::sq(in_SideLen), T{});
+		}
+		GridSystem(int in_width, int in_height) :
+			Width(in_width), Height(in_height)
+		{
+			this->map.assign(in_width * in_height, T{});
+		}
+
+
+		void fill(const vector<tx::Coord>& coords, const T& val) {
+			for (const tx::Coord& i : coords) {
+				this->at(i) = val;
+			}
+		}
+		void clear(const T& val = T{}) {
+			std::fill(this->map.begin(), this->map.end(), val);
+		}
+
+
+
+		inline T& atIndex(int index) { return this->map[index]; }
+		inline T& at(const tx::Coord& pos) {
+			return this->at(pos.x(), pos.y());
+		}
+		inline T& at(int x, int y) {
+			return this->map[index(x, y)];
+		}
+		inline const T& atIndex(int index) const { return this->map[index]; }
+		inline const T& at(const tx::Coord& pos) const { return this->map[index(pos)]; }
+		inline T* atSafe(const tx::Coord& pos) {
+			return this->atSafe(pos.x(), pos.y());
+		}
+		inline T* atSafe(int x, int y) {
+			if (valid(x, y))
+				return &this->map[index(x, y)];
+			else
+				return nullptr;
+		}
+		inline void set(const tx::Coord& pos, const T& val) {
+			this->at(pos.x(), pos.y()) = val;
+		}
+		inline void set(int x, int y, const T& val) {
+			this->at(x, y) = val;
+		}
+		inline bool valid(const tx::Coord& pos) const {
+			return valid(pos.x(), pos.y());
+		}
+		inline bool valid(int x, int y) const {
+			return (x < this->Width && y < this->Height && x > -1 && y > -1);
+		}
+		inline int getWidth() const { return this->Width; }
+		inline int getHeight() const { return this->Height; }
+		inline int size() const { return this->map.size(); }
+		inline int rowsize() const { return this->Width; }
+		inline tx::Coord getCoord(const tx::vec2& in) const { return tx::Coord{ static_cast<int>((in.x() + 1.0f) / 2.0f * Width), static_cast<int>((in.y() + 1.0f) / 2.0f * Height) }; }
+		inline int index(int x, int y) const { return y * this->Width + x; }
+		inline int index(const tx::Coord& in) const { return index(in.x(), in.y()); }
+		inline tx::Coord coord(int index) const { return tx::Coord{ index % this->Width, index / this->Width }; }
+
+
+		inline void reinit(int in_sideLen) {
+			map.clear();
+			this->map.assign(tx::sq(in_sideLen), T{});
+			Width = Height = in_sideLen;
+		}
+
+		inline vector<T>& data() { return map; }
+
+		
+		template<class Func>
+		void foreach(const Func& func){
+			static_assert(
+				std::is_invocable_v<Func, T&> || std::is_invocable_v<Func, T> || 
+				std::is_invocable_v<Func, T&, tx::Coord&> || std::is_invocable_v<Func, T&, tx::Coord> ||
+				std::is_invocable_v<Func, T , tx::Coord&> || std::is_invocable_v<Func, T , tx::Coord>,
+				"tx::GridSystem::foreach: invalid callback function");
+			
+			if constexpr (std::is_invocable_v<Func, T&, tx::Coord&>) {
+				tx::Coord cur{0, 0};
+				for(; cur.y() < Height; cur.moveY(1)) {
+					for(; cur.x() < Width; cur.moveX(1)){
+						func(at(cur), cur);
+					} cur.setX(0);
+				}
+			} else {
+				for(T& i : map){
+					func(i);
+				}
+			}
+		}
+
+
+	private:
+		vector<T> map;
+		int Width = 0, Height = 0;
+	};
+
+	class GridCircle {
+	public:
+		GridCircle(float in_radius) {
+			float rsq = tx::sq(in_radius);
+			this->radius = std::ceil(in_radius - 0.5f);
+			int sectorRange = this->radius - 1;
+			float height = 0.5f;
+			for (int i = 0; i < sectorRange; i++) {
+				//sector.push_back(std::cos(std::asinf(height / in_radius)) * in_radius)
+				sector.push_back(std::ceil(std::sqrtf(rsq - tx::sq(height)) - 0.5f));
+				height += 1.0f;
+			}
+			sector.push_back(std::ceil(std::sqrtf(rsq - tx::sq(height)) - 0.5f));
+		}
+
+		void getBitMap(const tx::Coord& center, vector<tx::Coord>& buffer) {
+			buffer.reserve(getGridAmount());
+			buffer.clear();
+			buffer.push_back(center);
+			for (int j = 0; j < 2; j++) {
+				tx::Coord temp = center;
+				for (int i = 0; i < this->radius; i++) {
+					temp += _4wayIncrement[j];
+					buffer.push_back(temp);
+				}
+			}
+
+			for (int row = 0; row < this->sector.size(); row++) {
+				int rowOffset = this->sector[row];
+				for (int i = -rowOffset; i <= rowOffset; i++) {
+					buffer.push_back(center + tx::Coord(i, row + 1));
+					buffer.push_back(center + tx::Coord(i, -(row + 1)));
+				}
+			}
+			sortBitmap(buffer);
+		}
+
+		template<class T>
+		void applyToGridSys(const tx::Coord& center, GridSystem<T>& gs, const T& val) {
+			gs.set(center, val);
+			for (int j = 0; j < 2; j++) {
+				tx::Coord temp = center;
+				for (int i = 0; i < this->radius; i++) {
+					temp += _4wayIncrement[j];
+					gs.set(temp, val);
+				}
+			}
+
+			for (int row = 0; row < this->sector.size(); row++) {
+				int rowOffset = this->sector[row];
+				for (int i = -rowOffset; i <= rowOffset; i++) {
+					gs.set(center + tx::Coord(i,  row + 1), val);
+					gs.set(center + tx::Coord(i, -row - 1), val);
+				}
+			}
+		}
+
+		int getGridAmount() {
+			return std::ceil(tx::sq(this->radius) * PI);
+			//return 4 * (tx::sq(this->radius) - this->radius) + 1;
+		}
+
+	private:
+		vector<int> sector; // the x offset for each row from the center
+		int radius;
+
+
+
+	};
+}
@@ -0,0 +1,275 @@
+// Copyright@TXLib All rights reserved.
+// Author: TX Studio: TX_Jerry
+// File: TXLib_Job
+
+#pragma once
+#include "txlib.hpp"
+#include "txgrid.hpp"
+
+namespace tx {
+
+	// Work-stealing job system.
+	// Every worker owns a deque: it pushes and pops its own jobs at the back (newest first, still
+	// warm in cache) and steals from the front of the others' deques when it runs dry. Threads that
+	// are not workers (main thread, simulation thread) share one extra deque. A thread that waits
+	// for a job or a parallel_for runs queued jobs in the meantime instead of blocking.
+	class JobSystem {
+	public:
+		struct Job {
+			std::function<void()> func;
+			std::atomic<int> pending{ 1 };		// unfinished dependencies, + 1 until submit() is done with it
+			std::atomic<bool> finished{ false };
+			std::mutex mx;						// guards dependents against a concurrent finish
+			vector<std::shared_ptr<Job>> dependents;
+		};
+		using JobHandle = std::shared_ptr<Job>;
+
+		static int defaultThreadAmount() {
+			return std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+		}
+
+		explicit JobSystem(int threadAmount = defaultThreadAmount()) : queues(threadAmount + 1) {
+			for (int i = 0; i < threadAmount; ++i) {
+				threads.emplace_back([this, i]() { worker_impl(i); });
+			}
+		}
+		// jobs still queued are dropped
+		~JobSystem() {
+			{
+				std::lock_guard<std::mutex> lock(mx_sleep);
+				running = false;
+			}
+			cv_work.notify_all();
+			for (std::thread& t : threads) t.join();
+		}
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		inline int threadAmount() const { return static_cast<int>(threads.size()); }
+
+		// Runs func once every job in deps has finished (null or finished dependencies are skipped)
+		JobHandle submit(std::function<void()> func, std::initializer_list<JobHandle> deps = {}) {
+			return submit_impl(std::move(func), deps.begin(), deps.end());
+		}
+		JobHandle submit(std::function<void()> func, const vector<JobHandle>& deps) {
+			return submit_impl(std::move(func), deps.data(), deps.data() + deps.size());
+		}
+
+		// Blocks until job has finished, running other jobs meanwhile
+		void wait(const JobHandle& job) {
+			if (!job) return;
+			while (!job->finished.load(std::memory_order_acquire)) {
+				if (!runOne_impl()) std::this_thread::yield();
+			}
+		}
+		void wait(const vector<JobHandle>& jobs) {
+			for (const JobHandle& job : jobs) wait(job);
+		}
+
+		// func(rangeBegin, rangeEnd) over [begin, end) in pieces of grain; returns when all are done.
+		// The calling thread takes the first piece.
+		template<class Func>
+		void parallel_for(int begin, int end, int grain, const Func& func) {
+			if (end <= begin) return;
+			grain = std::max(1, grain);
+			int pieces = (end - begin + grain - 1) / grain;
+			if (pieces == 1 || threads.empty()) {
+				func(begin, end);
+				return;
+			}
+			std::atomic<int> remaining{ pieces - 1 };
+			for (int i = pieces - 1; i >= 1; --i) {
+				int pieceBegin = begin + i * grain;
+				int pieceEnd = std::min(end, pieceBegin + grain);
+				JobHandle job = std::make_shared<Job>();
+				job->func = [&func, &remaining, pieceBegin, pieceEnd]() {
+					func(pieceBegin, pieceEnd);
+					remaining.fetch_sub(1, std::memory_order_release);
+				};
+				job->pending.store(0, std::memory_order_relaxed);
+				push_impl(std::move(job));
+			}
+			func(begin, std::min(end, begin + grain));
+			while (remaining.load(std::memory_order_acquire) > 0) {
+				if (!runOne_impl()) std::this_thread::yield();
+			}
+		}
+		// Row ranges of a grid: func(rowBegin, rowEnd), rowsPerJob rows per piece
+		template<class T, class Func>
+		void parallel_for(const GridSystem<T>& grid, int rowsPerJob, const Func& func) {
+			parallel_for(0, grid.getHeight(), rowsPerJob, func);
+		}
+
+	private:
+		struct WorkQueue {
+			std::mutex mx;
+			std::deque<JobHandle> jobs;
+		};
+
+		vector<std::thread> threads;
+		vector<WorkQueue> queues;		// one per worker, the last one is shared by outside threads
+		std::atomic<int> queued{ 0 };
+		std::atomic<int> sleeping{ 0 };
+		std::mutex mx_sleep;
+		std::condition_variable cv_work;
+		bool running = true;
+
+		inline static thread_local JobSystem* tl_owner = nullptr;
+		inline static thread_local int tl_index = -1;
+
+		inline int ownQueue_impl() const {
+			return tl_owner == this ? tl_index : static_cast<int>(queues.size()) - 1;
+		}
+
+		template<class It>
+		JobHandle submit_impl(std::function<void()> func, It depBegin, It depEnd) {
+			JobHandle job = std::make_shared<Job>();
+			job->func = std::move(func);
+			for (It it = depBegin; it != depEnd; ++it) {
+				const JobHandle& dep = *it;
+				if (!dep) continue;
+				std::lock_guard<std::mutex> lock(dep->mx);
+				if (dep->finished.load(std::memory_order_relaxed)) continue;
+				job->pending.fetch_add(1, std::memory_order_relaxed);
+				dep->dependents.push_back(job);
+			}
+			release_impl(job);
+			return job;
+		}
+
+		// drops one pending count, the last one queues the job
+		void release_impl(const JobHandle& job) {
+			if (job->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) push_impl(job);
+		}
+
+		void push_impl(JobHandle job) {
+			WorkQueue& queue = queues[ownQueue_impl()];
+			{
+				std::lock_guard<std::mutex> lock(queue.mx);
+				queue.jobs.push_back(std::move(job));
+			}
+			queued.fetch_add(1);
+			if (sleeping.load() == 0) return;
+			{
+				// a worker between its predicate check and the wait holds mx_sleep, so the wake-up cannot be lost
+				std::lock_guard<std::mutex> lock(mx_sleep);
+			}
+			cv_work.notify_one();
+		}
+
+		// own deque from the back, then the others from the front
+		JobHandle pop_impl() {
+			int own = ownQueue_impl();
+			int count = static_cast<int>(queues.size());
+			for (int k = 0; k < count; ++k) {
+				WorkQueue& queue = queues[(own + k) % count];
+				std::lock_guard<std::mutex> lock(queue.mx);
+				if (queue.jobs.empty()) continue;
+				JobHandle job;
+				if (k == 0) {
+					job = std::move(queue.jobs.back());
+					queue.jobs.pop_back();
+				} else {
+					job = std::move(queue.jobs.front());
+					queue.jobs.pop_front();
+				}
+				queued.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+			return nullptr;
+		}
+
+		bool runOne_impl() {
+			JobHandle job = pop_impl();
+			if (!job) return false;
+			execute_impl(*job);
+			return true;
+		}
+
+		void execute_impl(Job& job) {
+			job.func();
+			job.func = nullptr;
+			vector<JobHandle> dependents;
+			{
+				std::lock_guard<std::mutex> lock(job.mx);
+				job.finished.store(true, std::memory_order_release);
+				dependents.swap(job.dependents);
+			}
+			for (const JobHandle& dependent : dependents) release_impl(dependent);
+		}
+
+		void worker_impl(int index) {
+			tl_owner = this;
+			tl_index = index;
+			for (;;) {
+				if (runOne_impl()) continue;
+				std::unique_lock<std::mutex> lock(mx_sleep);
+				sleeping.fetch_add(1);
+				cv_work.wait(lock, [this]() { return !running || queued.load() > 0; });
+				sleeping.fetch_sub(1);
+				if (!running) return;
+			}
+		}
+	};
+
+	using JobHandle = JobSystem::JobHandle;
+
+	// Deferred work run in time slices on the thread that calls run(), within a budget per call.
+	// A task is called once per slice and does a bounded piece of its work each time, returning
+	// true once it is complete. Tasks take turns; a slice only starts while the budget left can fit
+	// the task's average slice so far, except that every call runs at least one slice, so a task
+	// whose slices are larger than the budget still moves on, one slice per call.
+	class BackgroundScheduler {
+	public:
+		using Task = std::function<bool()>;
+
+		// from any thread
+		void post(Task task) {
+			std::lock_guard<std::mutex> lock(mx_posted);
+			posted.push_back(std::move(task));
+		}
+
+		// budget: ms
+		void run(double budget) {
+			Time::Timer timer;
+			{
+				std::lock_guard<std::mutex> lock(mx_posted);
+				for (Task& task : posted) tasks.push_back({ std::move(task), 0.0 });
+				posted.clear();
+			}
+			bool first = true;
+			while (!tasks.empty()) {
+				next %= tasks.size();
+				Entry& entry = tasks[next];
+				if (!first && timer.duration() + entry.averageSlice > budget) break;
+				first = false;
+				Time::Timer slice;
+				bool done = entry.task();
+				entry.averageSlice = entry.averageSlice == 0.0 ? slice.duration() : entry.averageSlice * 0.75 + slice.duration() * 0.25;
+				if (done) tasks.erase(tasks.begin() + next);
+				else ++next;
+			}
+			lastDuration = timer.duration();
+		}
+
+		// run() thread: tasks not complete yet, posted ones included
+		size_t pending() {
+			std::lock_guard<std::mutex> lock(mx_posted);
+			return tasks.size() + posted.size();
+		}
+		inline double getLastDuration() const { return lastDuration; }	// ms the last run() took
+
+	private:
+		struct Entry {
+			Task task;
+			double averageSlice;	// ms
+		};
+		vector<Entry> tasks;	// run() thread only
+		size_t next = 0;		// whose slice is next
+		double lastDuration = 0.0;
+
+		std::mutex mx_posted;
+		vector<Task> posted;
+	};
+
+}
@@ -0,0 +1,64 @@
+// Copyright@TXLib All rights reserved.
+// Author: TX Studio: TX_Jerry
+// File: TXLib_Random
+
+#pragma once
+#include "txlib.hpp"
+
+namespace tx {
+
+	// Counter-based random numbers: the n-th number of a stream is a hash of (key, n).
+	// A stream is two integers, cheap to copy and to keep per chunk or per job, and split() derives
+	// independent streams from it, one per subsystem, chunk or work item. Parallel code then draws
+	// from streams of its own instead of sharing one generator, and the numbers only depend on the
+	// seed and the stream, not on which thread ran first.
+	// The uniform helpers do their own mapping: std distributions differ between standard libraries.
+	class Random {
+	public:
+		using result_type = uint64_t;
+
+		constexpr explicit Random(uint64_t seed = 0) : key(mix(seed ^ 0x6a09e667f3bcc909ull)) {}
+
+		// independent stream for stream id (subsystem, chunk index, ...); does not advance this one
+		constexpr Random split(uint64_t stream) const {
+			Random child;
+			child.key = mix(key ^ mix(stream + Golden));
+			return child;
+		}
+
+		constexpr uint64_t operator()() { return at(counter++); }
+		// the index-th number of the stream, without advancing it
+		constexpr uint64_t at(uint64_t index) const { return mix(mix(key + index * Golden) ^ key); }
+
+		// integer in [min, max]
+		constexpr int uniform(int min, int max) {
+			uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+			return static_cast<int>(min + static_cast<int64_t>(((operator()() >> 32) * range) >> 32));
+		}
+		// float in [0, 1)
+		constexpr float uniform01() {
+			return static_cast<float>(operator()() >> 40) * (1.0f / 16777216.0f);
+		}
+
+		// numbers drawn so far
+		constexpr uint64_t position() const { return counter; }
+		constexpr uint64_t getKey() const { return key; }
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return ~result_type{ 0 }; }
+
+	private:
+		static constexpr uint64_t Golden = 0x9e3779b97f4a7c15ull;
+
+		uint64_t key = 0;
+		uint64_t counter = 0;
+
+		// splitmix64 finalizer
+		static constexpr uint64_t mix(uint64_t x) {
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+			return x ^ (x >> 31);
+		}
+	};
+
+}
@@ -0,0 +1,87 @@
+// Copyright@TXLib All rights reserved.
+// Author: TX Studio: TX_Jerry
+// File: TXLib_Sync
+
+#pragma once
+#include "txlib.hpp"
+
+namespace tx {
+
+	// Triple buffer between one writer thread and one reader thread.
+	// The writer fills back() and publish()es it; read() hands the reader the newest published buffer.
+	// Neither side ever waits: the writer always has a buffer of its own to fill, and the reader keeps
+	// the one it holds until a newer one is published. Buffers are reused, so their memory is too.
+	template<class T>
+	class TripleBuffer {
+	public:
+		// writer: the buffer to fill next
+		inline T& back() { return buffers[backIndex]; }
+		// writer: hands back() over, replacing a published buffer the reader has not picked up yet
+		void publish() {
+			uint8_t old = middle.exchange(static_cast<uint8_t>(backIndex | Fresh), std::memory_order_acq_rel);
+			backIndex = old & IndexMask;
+		}
+		// writer: the last published buffer was not picked up by the reader yet
+		inline bool unread() const { return middle.load(std::memory_order_relaxed) & Fresh; }
+
+		// reader: the newest published buffer, the same one again if nothing was published since
+		const T& read() {
+			if (middle.load(std::memory_order_relaxed) & Fresh) {
+				uint8_t old = middle.exchange(frontIndex, std::memory_order_acq_rel);
+				frontIndex = old & IndexMask;
+			}
+			return buffers[frontIndex];
+		}
+		// reader: the buffer the last read() returned
+		inline const T& front() const { return buffers[frontIndex]; }
+
+	private:
+		static constexpr uint8_t IndexMask = 3;
+		static constexpr uint8_t Fresh = 4;	// set while the middle buffer was not read yet
+
+		std::array<T, 3> buffers{};
+		std::atomic<uint8_t> middle{ 1 };
+		uint8_t backIndex = 0;		// writer only
+		uint8_t frontIndex = 2;		// reader only
+	};
+
+	// Bounded queue between one producer thread and one consumer thread, without locks.
+	// Each side owns one index and only reads the other's, so push() and pop() never wait;
+	// push() fails instead when the queue is full. Capacity must be a power of two.
+	template<class T, size_t Capacity>
+	class SpscQueue {
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two.");
+	public:
+		// producer
+		bool push(const T& value) {
+			size_t tail = this->tail.load(std::memory_order_relaxed);
+			if (tail - this->head.load(std::memory_order_acquire) == Capacity) return false;
+			slots[tail & Mask] = value;
+			this->tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer
+		bool pop(T& value) {
+			size_t head = this->head.load(std::memory_order_relaxed);
+			if (head == this->tail.load(std::memory_order_acquire)) return false;
+			value = slots[head & Mask];
+			this->head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+		// consumer: the element pop() would return next, nullptr while the queue is empty
+		const T* peek() const {
+			size_t head = this->head.load(std::memory_order_relaxed);
+			if (head == this->tail.load(std::memory_order_acquire)) return nullptr;
+			return &slots[head & Mask];
+		}
+
+	private:
+		static constexpr size_t Mask = Capacity - 1;
+
+		std::array<T, Capacity> slots{};
+		alignas(64) std::atomic<size_t> head{ 0 };	// next to pop, written by the consumer
+		alignas(64) std::atomic<size_t> tail{ 0 };	// next to push, written by the producer
+	};
+
+}
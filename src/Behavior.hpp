@@ -0,0 +1,91 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include <coroutine>
+
+// Building behaviors written as C++20 coroutines.
+// A behavior is an endless loop that co_awaits the condition it needs next (a number of ticks,
+// an item, free space); while suspended it is either on a timer or parked on the WaitLists of
+// the buildings it waits for, and costs nothing per tick until one of them wakes it.
+
+class WaitList;
+struct BehaviorPromise;
+using BehaviorHandle = std::coroutine_handle<BehaviorPromise>;
+
+// Owns the coroutine frame; move-only, the frame is destroyed with the owning building
+class Behavior {
+public:
+    using promise_type = BehaviorPromise;
+
+    Behavior() = default;
+    explicit Behavior(BehaviorHandle in_handle) : m_handle(in_handle) {}
+    Behavior(Behavior&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Behavior& operator=(Behavior&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    Behavior(const Behavior&) = delete;
+    Behavior& operator=(const Behavior&) = delete;
+    ~Behavior() { if (m_handle) m_handle.destroy(); }
+
+    BehaviorHandle handle() const { return m_handle; }
+    bool valid() const { return static_cast<bool>(m_handle); }
+
+private:
+    BehaviorHandle m_handle = nullptr;
+};
+
+struct BehaviorPromise {
+    static constexpr int MaxParked = 4;  // e.g. an extractor waiting on all of its output belts
+
+    std::array<WaitList*, MaxParked> parkedOn{};
+    int parkedCount = 0;
+    bool queued = false;  // already in the scheduler's ready list
+
+    Behavior get_return_object() { return Behavior{ BehaviorHandle::from_promise(*this) }; }
+    std::suspend_always initial_suspend() noexcept { return {}; }  // started by the scheduler
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+};
+
+// Behaviors sleeping on a building until it reports the condition they wait for
+class WaitList {
+public:
+    void park(BehaviorHandle handle) {
+        waiters.push_back(handle);
+        BehaviorPromise& promise = handle.promise();
+        promise.parkedOn[promise.parkedCount++] = this;
+    }
+    void remove(BehaviorHandle handle) {
+        auto it = std::find(waiters.begin(), waiters.end(), handle);
+        if (it != waiters.end()) waiters.erase(it);
+    }
+    bool empty() const { return waiters.empty(); }
+    // moves every waiter to the ready list (once, even if it is parked on several lists)
+    void wakeInto(vector<BehaviorHandle>& ready) {
+        for (BehaviorHandle handle : waiters) {
+            if (handle.promise().queued) continue;
+            handle.promise().queued = true;
+            ready.push_back(handle);
+        }
+        waiters.clear();
+    }
+    // moves every waiter to woken without marking it queued; for updates running in parallel,
+    // the caller hands them to the scheduler later (see World::queueWoken_impl)
+    void takeInto(vector<BehaviorHandle>& woken) {
+        woken.insert(woken.end(), waiters.begin(), waiters.end());
+        waiters.clear();
+    }
+private:
+    vector<BehaviorHandle> waiters;
+};
+
+// takes a behavior off every list it is parked on
+inline void unparkBehavior(BehaviorHandle handle) {
+    BehaviorPromise& promise = handle.promise();
+    for (int i = 0; i < promise.parkedCount; ++i) promise.parkedOn[i]->remove(handle);
+    promise.parkedCount = 0;
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+
+// All buildings of one kind: ids into pages of PageSize slots, stored side by side.
+// Slots never move, so buildings can point at each other and behaviors can hold references to
+// them. An id stays valid until the building is destroyed; its slot, and the id, then go to the
+// next building of that kind. Iteration visits the buildings in id order, page by page.
+template<class T, int PageSize = 64>
+class BuildingStore {
+public:
+    using Id = uint32_t;
+
+    // the new building is (*this)[id]
+    Id create() {
+        Id id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        } else {
+            id = slotCount++;
+            if (id % PageSize == 0) pages.push_back(std::make_unique<std::optional<T>[]>(PageSize));
+        }
+        ++count;
+        slot_impl(id).emplace();
+        return id;
+    }
+    void destroy(Id id) {
+        std::optional<T>& slot = slot_impl(id);
+        if (!slot) return;
+        slot.reset();
+        freeIds.push_back(id);
+        --count;
+    }
+
+    T& operator[](Id id) { return *slot_impl(id); }
+    const T& operator[](Id id) const { return *slot_impl(id); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    template<class Store, class V>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        Iterator(Store* in_store, Id in_id) : store(in_store), id(in_id) { skip_impl(); }
+        V& operator*() const { return *store->slot_impl(id); }
+        V* operator->() const { return &*store->slot_impl(id); }
+        Iterator& operator++() { ++id; skip_impl(); return *this; }
+        bool operator==(const Iterator& other) const { return id == other.id; }
+
+    private:
+        Store* store;
+        Id id;
+        void skip_impl() {
+            while (id < store->slotCount && !store->slot_impl(id)) ++id;
+        }
+    };
+    using iterator = Iterator<BuildingStore, T>;
+    using const_iterator = Iterator<const BuildingStore, const T>;
+
+    iterator begin() { return { this, 0 }; }
+    iterator end() { return { this, slotCount }; }
+    const_iterator begin() const { return { this, 0 }; }
+    const_iterator end() const { return { this, slotCount }; }
+
+private:
+    vector<std::unique_ptr<std::optional<T>[]>> pages;
+    vector<Id> freeIds;
+    Id slotCount = 0;  // slots handed out so far, free ones included
+    size_t count = 0;
+
+    std::optional<T>& slot_impl(Id id) { return pages[id / PageSize][id % PageSize]; }
+    const std::optional<T>& slot_impl(Id id) const { return pages[id / PageSize][id % PageSize]; }
+};
+
+// The buildings of one kind in one chunk that a system updates every tick, active ones first.
+// The system only walks the active part; a building it finds idle is swapped behind it and costs
+// nothing until whatever gives it work again calls wake(). T keeps its place in the list in
+// activeList / activeSlot. Belts and crafters are the only buildings walked every tick; the
+// others either run as behaviors, resumed only when due, or have no update at all.
+template<class T>
+class ActiveList {
+public:
+    void add(T* item) {
+        item->activeList = this;
+        item->activeSlot = static_cast<uint32_t>(items.size());
+        items.push_back(item);
+        activate(item);
+    }
+    void remove(T* item) {
+        deactivate(item);
+        T* last = items.back();
+        move_impl(last, item->activeSlot);
+        items.pop_back();
+        item->activeList = nullptr;
+    }
+
+    void activate(T* item) {
+        if (item->activeSlot < activeCount) return;
+        swap_impl(item, items[activeCount]);
+        ++activeCount;
+    }
+    // the last active item takes item's place: while walking the active part, do not step on
+    void deactivate(T* item) {
+        if (item->activeSlot >= activeCount) return;
+        --activeCount;
+        swap_impl(item, items[activeCount]);
+    }
+    static void wake(T& item) {
+        if (item.activeList) item.activeList->activate(&item);
+    }
+
+    size_t active() const { return activeCount; }
+    size_t size() const { return items.size(); }
+    T* operator[](size_t i) const { return items[i]; }
+
+private:
+    vector<T*> items;
+    uint32_t activeCount = 0;
+
+    void move_impl(T* item, uint32_t slot) {
+        items[slot] = item;
+        item->activeSlot = slot;
+    }
+    void swap_impl(T* a, T* b) {
+        uint32_t slotA = a->activeSlot, slotB = b->activeSlot;
+        move_impl(a, slotB);
+        move_impl(b, slotA);
+    }
+};
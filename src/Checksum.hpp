@@ -0,0 +1,37 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include <bit>
+
+// 64-bit hash of simulation state, fed field by field.
+// Floats are hashed by their bits, so two runs only agree when they computed exactly the same
+// values; that is the point: the parallel and chunked paths must match the single-threaded one.
+class StateHash {
+public:
+    StateHash& add(uint64_t value) {
+        // splitmix64 finalizer over the running value, cheap and every input bit reaches every output bit
+        state = mix(state ^ (value + 0x9e3779b97f4a7c15ull + (state << 6) + (state >> 2)));
+        return *this;
+    }
+    StateHash& add(int64_t value)  { return add(static_cast<uint64_t>(value)); }
+    StateHash& add(int value)      { return add(static_cast<uint64_t>(static_cast<uint32_t>(value))); }
+    StateHash& add(uint32_t value) { return add(static_cast<uint64_t>(value)); }
+    StateHash& add(uint16_t value) { return add(static_cast<uint64_t>(value)); }
+    StateHash& add(uint8_t value)  { return add(static_cast<uint64_t>(value)); }
+    StateHash& add(bool value)     { return add(static_cast<uint64_t>(value)); }
+    StateHash& add(float value) {
+        return add(std::bit_cast<uint32_t>(value));
+    }
+    StateHash& add(const tx::Coord& pos) { return add(pos.x()).add(pos.y()); }
+    StateHash& add(const tx::vec2& v)    { return add(v.x()).add(v.y()); }
+
+    uint64_t value() const { return state; }
+
+    static constexpr uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+private:
+    uint64_t state = 0xcbf29ce484222325ull;
+};
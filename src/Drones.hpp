@@ -0,0 +1,179 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include "TXLib/txgrid.hpp"
+#include "FlowFields.hpp"
+
+// Logistics drones.
+// Navigation uses flow fields (FlowFields.hpp): one field per destination over the tile grid,
+// shared by every drone heading there, so steering a drone is a single lookup per tick. Drones keep apart with a
+// uniform-grid broadphase (same layout as GravitySys in Reference/main.cpp: cells as large as the
+// interaction distance, each pair checked once through half of the 8 neighbouring cells). Only the
+// drones are sorted by cell, the grid itself is never stored, so the cost follows the drone count
+// rather than the map size.
+// Positions are in tile units: tile (x, y) covers [x, x + 1) x [y, y + 1).
+
+struct Drone {
+    tx::vec2 pos = { 0.0f, 0.0f };
+    tx::vec2 vel = { 0.0f, 0.0f };
+    int destination = -1;   // tile index, -1 = hover in place
+    uint32_t mission = 0;   // owner's bookkeeping
+    uint16_t item = 0;
+    bool carrying = false;
+};
+
+class DroneSwarm {
+public:
+    static constexpr float Radius = 0.12f;       // tiles
+    static constexpr float Speed = 3.0f;         // tiles per second
+    static constexpr float Steering = 8.0f;      // how fast velocity turns towards the field, 1/s
+    static constexpr float Separation = 0.5f;    // share of an overlap resolved per tick
+    static constexpr float ArriveDistance = 0.35f;
+    static constexpr int MaxCellOccupation = 50; // drones per cell taking part in separation, as in GravitySys
+
+    void reinit(int in_width, int in_height) {
+        width = in_width;
+        height = in_height;
+        cellSize = Radius * 2.0f;
+        cellsX = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+        cellsY = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+        drones.clear();
+    }
+
+    Drone& spawn(const tx::vec2& pos, int destination) {
+        drones.emplace_back();
+        drones.back().pos = pos;
+        drones.back().destination = destination;
+        return drones.back();
+    }
+
+    int size() const { return static_cast<int>(drones.size()); }
+    Drone& operator[](int i) { return drones[i]; }
+    vector<Drone>& data() { return drones; }
+    const vector<Drone>& data() const { return drones; }
+
+    int tileIndex(const tx::vec2& pos) const {
+        int x = std::clamp(static_cast<int>(pos.x()), 0, width - 1);
+        int y = std::clamp(static_cast<int>(pos.y()), 0, height - 1);
+        return y * width + x;
+    }
+    bool arrived(const Drone& drone) const {
+        if (drone.destination < 0) return false;
+        tx::vec2 target = tileCenter_impl(drone.destination);
+        return tx::sq(drone.pos.x() - target.x()) + tx::sq(drone.pos.y() - target.y()) < tx::sq(ArriveDistance);
+    }
+
+    void update(float dt, FlowFieldCache& fields) {
+        steer_impl(dt, fields);
+        buildCells_impl();
+        separate_impl();
+        for (Drone& drone : drones) {
+            drone.pos += drone.vel * dt;
+            drone.pos = tx::vec2{ std::clamp(drone.pos.x(), 0.0f, width - 0.001f), std::clamp(drone.pos.y(), 0.0f, height - 0.001f) };
+        }
+    }
+
+private:
+    int width = 0, height = 0;
+    float cellSize = 0.24f;
+    int cellsX = 1, cellsY = 1;
+    vector<Drone> drones;
+    vector<std::pair<uint32_t, int>> cellDrones;  // (cell, drone) this tick, sorted: a cell's drones are one run
+
+    // half of the neighbourhood, like GravitySys::gridAdjacentIncrement
+    inline static const std::array<tx::Coord, 4> HalfNeighbours = {
+        tx::Coord{ 1, 1 }, tx::Coord{ 0, 1 }, tx::Coord{ -1, 1 }, tx::Coord{ -1, 0 }
+    };
+
+    tx::vec2 tileCenter_impl(int index) const {
+        return tx::vec2{ (index % width) + 0.5f, (index / width) + 0.5f };
+    }
+
+    void steer_impl(float dt, FlowFieldCache& fields) {
+        // consecutive drones usually share a destination, so the field lookup is mostly skipped
+        FlowField* field = nullptr;
+        int fieldDestination = -1;
+        float blend = std::min(1.0f, Steering * dt);
+        for (Drone& drone : drones) {
+            tx::vec2 desired{ 0.0f, 0.0f };
+            if (drone.destination >= 0) {
+                if (fieldDestination != drone.destination) {
+                    field = fields.get(drone.destination);
+                    fieldDestination = drone.destination;
+                }
+                int tile = tileIndex(drone.pos);
+                if (!field) {
+                    // field still being generated: fly straight at the destination
+                    tx::vec2 toTarget = tileCenter_impl(drone.destination) - drone.pos;
+                    float len = std::sqrt(tx::sq(toTarget.x()) + tx::sq(toTarget.y()));
+                    if (len > tx::epsilon) desired = toTarget * (Speed / len);
+                } else if (tile == drone.destination) {
+                    // inside the destination tile: head for its centre and slow down
+                    tx::vec2 toCenter = tileCenter_impl(tile) - drone.pos;
+                    desired = toCenter * (Speed * 2.0f);
+                    float len = std::sqrt(tx::sq(desired.x()) + tx::sq(desired.y()));
+                    if (len > Speed) desired = desired * (Speed / len);
+                } else {
+                    desired = field->steer(tile) * Speed;
+                }
+            }
+            drone.vel += (desired - drone.vel) * blend;
+        }
+    }
+
+    void buildCells_impl() {
+        cellDrones.resize(drones.size());
+        for (int i = 0; i < size(); ++i) {
+            int cx = std::clamp(static_cast<int>(drones[i].pos.x() / cellSize), 0, cellsX - 1);
+            int cy = std::clamp(static_cast<int>(drones[i].pos.y() / cellSize), 0, cellsY - 1);
+            cellDrones[i] = { static_cast<uint32_t>(cy * cellsX + cx), i };
+        }
+        std::sort(cellDrones.begin(), cellDrones.end());
+    }
+
+    // the run of cell's drones in cellDrones, at most MaxCellOccupation long
+    std::pair<size_t, size_t> cellRange_impl(uint32_t cell) const {
+        auto begin = std::lower_bound(cellDrones.begin(), cellDrones.end(), std::pair<uint32_t, int>{ cell, -1 });
+        auto end = std::lower_bound(begin, cellDrones.end(), std::pair<uint32_t, int>{ cell + 1, -1 });
+        size_t first = begin - cellDrones.begin();
+        return { first, std::min(static_cast<size_t>(end - cellDrones.begin()), first + MaxCellOccupation) };
+    }
+
+    void push_impl(Drone& a, Drone& b) {
+        float dx = b.pos.x() - a.pos.x();
+        float dy = b.pos.y() - a.pos.y();
+        float d2 = dx * dx + dy * dy;
+        constexpr float MinDistance = Radius * 2.0f;
+        if (d2 >= MinDistance * MinDistance) return;
+        float d = std::sqrt(d2);
+        tx::vec2 normal = d > tx::epsilon ? tx::vec2{ dx / d, dy / d } : tx::vec2{ 1.0f, 0.0f };
+        tx::vec2 correction = normal * ((MinDistance - d) * Separation * 0.5f);
+        a.pos -= correction;
+        b.pos += correction;
+    }
+
+    // occupied cells only, in cell order; neighbour cells are found by binary search
+    void separate_impl() {
+        std::array<std::pair<size_t, size_t>, HalfNeighbours.size()> neighbours;
+        for (size_t begin = 0; begin < cellDrones.size();) {
+            uint32_t cell = cellDrones[begin].first;
+            size_t runEnd = begin;
+            while (runEnd < cellDrones.size() && cellDrones[runEnd].first == cell) ++runEnd;
+            // a crowded cell (e.g. drones queueing at a storage) only separates its first drones
+            size_t end = std::min(runEnd, begin + MaxCellOccupation);
+            int cx = static_cast<int>(cell % cellsX), cy = static_cast<int>(cell / cellsX);
+            for (size_t n = 0; n < HalfNeighbours.size(); ++n) {
+                int nx = cx + HalfNeighbours[n].x(), ny = cy + HalfNeighbours[n].y();
+                bool inside = nx >= 0 && nx < cellsX && ny >= 0 && ny < cellsY;
+                neighbours[n] = inside ? cellRange_impl(static_cast<uint32_t>(ny * cellsX + nx)) : std::pair<size_t, size_t>{ 0, 0 };
+            }
+            for (size_t i = begin; i < end; ++i) {
+                Drone& a = drones[cellDrones[i].second];
+                for (size_t j = i + 1; j < end; ++j) push_impl(a, drones[cellDrones[j].second]);
+                for (const auto& [first, last] : neighbours) {
+                    for (size_t j = first; j < last; ++j) push_impl(a, drones[cellDrones[j].second]);
+                }
+            }
+            begin = runEnd;
+        }
+    }
+};
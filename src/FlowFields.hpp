@@ -0,0 +1,442 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include "TXLib/txgrid.hpp"
+#include "TXLib/txjob.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Flow fields: distance to one destination tile from every tile, plus the direction to walk.
+// Fields are generated and repaired off the simulation thread. Distances are relaxed as a
+// wavefront over map chunks: every round, the chunks that received new distances relax
+// their own tiles in parallel and hand improvements across their borders to the next round.
+// Placing or removing a building only re-relaxes the tiles whose distance it can change.
+
+// Distances to one destination tile and the direction to walk from every tile
+class FlowField {
+public:
+    static constexpr uint16_t Unreachable = std::numeric_limits<uint16_t>::max();
+    static constexpr uint8_t NoDirection = 8;
+
+    int destination = -1;
+    tx::GridSystem<uint16_t> distance;
+    tx::GridSystem<uint8_t> direction;  // index into Steps, NoDirection at the destination / unreachable
+
+    // 8 neighbours; diagonal steps are only taken when both orthogonal tiles are open
+    inline static const std::array<tx::Coord, 8> Steps = {
+        tx::Coord{ 1, 0 }, tx::Coord{ -1, 0 }, tx::Coord{ 0, 1 }, tx::Coord{ 0, -1 },
+        tx::Coord{ 1, 1 }, tx::Coord{ -1, 1 }, tx::Coord{ 1, -1 }, tx::Coord{ -1, -1 }
+    };
+
+    void reset(int in_destination, int width, int height) {
+        destination = in_destination;
+        distance = tx::GridSystem<uint16_t>(width, height);
+        direction = tx::GridSystem<uint8_t>(width, height);
+        distance.clear(Unreachable);
+        direction.clear(NoDirection);
+        distance.atIndex(destination) = 0;
+    }
+
+    // blocked tiles get a distance (a drone starting inside one can leave) but are never walked through
+    bool expandable(int index, tx::GridSystem<uint8_t>& blocked) const {
+        return index == destination || !blocked.atIndex(index);
+    }
+
+    // unit vector towards the next tile (zero at the destination or when unreachable)
+    tx::vec2 steer(int index) {
+        uint8_t dir = direction.atIndex(index);
+        if (dir == NoDirection) return tx::vec2{ 0.0f, 0.0f };
+        constexpr float Diagonal = 0.70710678f;
+        const tx::Coord& step = Steps[dir];
+        float scale = dir < 4 ? 1.0f : Diagonal;
+        return tx::vec2{ step.x() * scale, step.y() * scale };
+    }
+
+    void computeDirection(int index, tx::GridSystem<uint8_t>& blocked) {
+        int width = distance.getWidth();
+        direction.atIndex(index) = NoDirection;
+        uint16_t best = distance.atIndex(index);
+        if (best == 0 || best == Unreachable) return;
+        tx::Coord pos{ index % width, index / width };
+        for (int i = 0; i < 8; ++i) {
+            tx::Coord n = pos + Steps[i];
+            if (!distance.valid(n)) continue;
+            if (!expandable(distance.index(n), blocked)) continue;
+            if (i >= 4) {
+                tx::Coord sideX{ n.x(), pos.y() }, sideY{ pos.x(), n.y() };
+                if (blocked.at(sideX) || blocked.at(sideY)) continue;
+            }
+            // an open diagonal is two BFS steps closer, so it wins over the orthogonal steps
+            uint16_t nd = distance.at(n);
+            if (nd < best) {
+                best = nd;
+                direction.atIndex(index) = static_cast<uint8_t>(i);
+            }
+        }
+    }
+};
+
+// Chunked wavefront relaxation of a field's distances from a set of seed tiles.
+// Seeds must already hold a correct (or upper-bound) distance; every tile they can improve is lowered.
+class WavefrontSolver {
+public:
+    static constexpr int ChunkSize = 16;  // tiles per chunk side
+
+    void reinit(int in_width, int in_height) {
+        width = in_width;
+        height = in_height;
+        chunksX = (width + ChunkSize - 1) / ChunkSize;
+        chunksY = (height + ChunkSize - 1) / ChunkSize;
+        inbox.assign(chunksX * chunksY, {});
+        outbox.assign(chunksX * chunksY, {});
+        changedByChunk.assign(chunksX * chunksY, {});
+    }
+
+    // changed receives every tile whose distance was lowered
+    void relax(FlowField& field, tx::GridSystem<uint8_t>& blocked, const vector<int>& seeds, vector<int>& changed, tx::JobSystem& jobs) {
+        for (int seed : seeds) inbox[chunkOf_impl(seed)].push_back(seed);
+        vector<int> active;
+        for (;;) {
+            active.clear();
+            for (int c = 0; c < static_cast<int>(inbox.size()); ++c) {
+                if (!inbox[c].empty()) active.push_back(c);
+            }
+            if (active.empty()) break;
+
+            // chunks only write their own tiles; improvements for neighbours go to the outbox
+            jobs.parallel_for(0, static_cast<int>(active.size()), 1, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) relaxChunk_impl(active[i], field, blocked);
+            });
+
+            // merge in chunk order so the result does not depend on thread timing
+            for (int c : active) {
+                changed.insert(changed.end(), changedByChunk[c].begin(), changedByChunk[c].end());
+                changedByChunk[c].clear();
+                for (const auto& [index, d] : outbox[c]) {
+                    uint16_t& current = field.distance.atIndex(index);
+                    if (d >= current) continue;
+                    current = d;
+                    changed.push_back(index);
+                    inbox[chunkOf_impl(index)].push_back(index);
+                }
+                outbox[c].clear();
+            }
+        }
+    }
+
+private:
+    int width = 0, height = 0;
+    int chunksX = 1, chunksY = 1;
+    vector<vector<int>> inbox;                          // tiles with a new distance, per chunk
+    vector<vector<std::pair<int, uint16_t>>> outbox;    // proposals for tiles of other chunks
+    vector<vector<int>> changedByChunk;
+
+    int chunkOf_impl(int index) const {
+        return (index / width / ChunkSize) * chunksX + (index % width) / ChunkSize;
+    }
+
+    // Dijkstra restricted to one chunk (unit weights: a bucket queue by distance)
+    void relaxChunk_impl(int chunk, FlowField& field, tx::GridSystem<uint8_t>& blocked) {
+        using Entry = std::pair<uint16_t, int>;
+        std::priority_queue<Entry, vector<Entry>, std::greater<Entry>> open;
+        for (int index : inbox[chunk]) open.push({ field.distance.atIndex(index), index });
+        inbox[chunk].clear();
+
+        while (!open.empty()) {
+            auto [d, index] = open.top();
+            open.pop();
+            if (d != field.distance.atIndex(index)) continue; // stale entry
+            if (!field.expandable(index, blocked)) continue;
+            int x = index % width, y = index / width;
+            uint16_t nd = d + 1;
+            for (int i = 0; i < 4; ++i) {
+                int nx = x + FlowField::Steps[i].x(), ny = y + FlowField::Steps[i].y();
+                if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+                int n = ny * width + nx;
+                if (chunkOf_impl(n) != chunk) {
+                    outbox[chunk].push_back({ n, nd });
+                    continue;
+                }
+                uint16_t& current = field.distance.atIndex(n);
+                if (nd >= current) continue;
+                current = nd;
+                changedByChunk[chunk].push_back(n);
+                open.push({ nd, n });
+            }
+        }
+    }
+};
+
+// Flow fields by destination tile.
+// The simulation thread only queues requests and picks up finished fields; a coordinator
+// thread builds and repairs them with the wavefront solver, on a job system of its own so it
+// never competes with the tick's jobs. A result becomes visible LatencyTicks after it was
+// requested, or on the first tick after that it is finished: until then drones keep following
+// the last complete field, and a tick never waits for path data. That makes the tick a field
+// changes on depend on thread timing; setWaitForResults(true) trades the stalls for
+// reproducible timing (see World::enableChecksum). Repairs are handed over as the tiles they changed.
+class FlowFieldCache {
+public:
+    static constexpr uint64_t LatencyTicks = 4;
+
+    FlowFieldCache() {}
+    ~FlowFieldCache() { stop_impl(); }
+    FlowFieldCache(const FlowFieldCache&) = delete;
+    FlowFieldCache& operator=(const FlowFieldCache&) = delete;
+
+    // threadAmount: workers helping the coordinator, 0 = it solves alone
+    void reinit(int in_width, int in_height, int threadAmount) {
+        stop_impl();
+        jobSystem = std::make_unique<tx::JobSystem>(threadAmount);
+        width = in_width;
+        height = in_height;
+        blocked = tx::GridSystem<uint8_t>(width, height);
+        workerBlocked = tx::GridSystem<uint8_t>(width, height);
+        published.clear();
+        requested.clear();
+        pendingReadyTicks.clear();
+        working.clear();
+        queuedJobs.clear();
+        finished.clear();
+        finishedJobs = 0;
+        publishedJobs = 0;
+        solver.reinit(width, height);
+        stamp.assign(width * height, 0);
+        currentStamp = 0;
+        tick = 0;
+        running = true;
+        coordinator = std::thread([this]() { coordinator_impl(); });
+    }
+
+    // a building that drones cannot fly through appeared or disappeared
+    void setBlocked(int index, bool value) {
+        if (blocked.atIndex(index) == static_cast<uint8_t>(value)) return;
+        blocked.atIndex(index) = value;
+        submit_impl(Job{ Job::Type::SetBlocked, index, value, tick + LatencyTicks });
+    }
+
+    // the latest published field, or nullptr while the first one is still being generated
+    FlowField* get(int destination) {
+        auto it = published.find(destination);
+        if (it != published.end()) return it->second.get();
+        if (requested.insert(destination).second) {
+            submit_impl(Job{ Job::Type::Build, destination, false, tick + LatencyTicks });
+        }
+        return nullptr;
+    }
+
+    // Waiting: every result is published exactly LatencyTicks after its request, update()
+    // blocks while the coordinator is behind. For checks comparing worlds tick by tick.
+    void setWaitForResults(bool value) { waitForResults = value; }
+
+    // once per tick: publishes the finished results that are due
+    void update() {
+        ++tick;
+        size_t dueJobs = 0;
+        while (dueJobs < pendingReadyTicks.size() && pendingReadyTicks[dueJobs] <= tick) ++dueJobs;
+        pendingReadyTicks.erase(pendingReadyTicks.begin(), pendingReadyTicks.begin() + dueJobs);
+        publishedJobs += dueJobs;
+
+        // the coordinator only holds the lock to queue its results, never while solving
+        std::unique_lock<std::mutex> lock(mx_jobs);
+        if (waitForResults) cv_finished.wait(lock, [this]() { return finishedJobs >= publishedJobs; });
+        size_t due = 0;
+        while (due < finished.size() && finished[due].readyTick <= tick) ++due;
+        for (size_t i = 0; i < due; ++i) {
+            Result& result = finished[i];
+            if (result.field) {
+                published[result.destination] = std::move(result.field);
+                continue;
+            }
+            FlowField& field = *published[result.destination];
+            for (const Patch& patch : result.patch) {
+                field.distance.atIndex(patch.index) = patch.distance;
+                field.direction.atIndex(patch.index) = patch.direction;
+            }
+        }
+        finished.erase(finished.begin(), finished.begin() + due);
+    }
+
+    int size() const { return static_cast<int>(published.size()); }
+
+private:
+    struct Job {
+        enum class Type { Build, SetBlocked } type;
+        int index;        // destination or changed tile
+        bool value;       // new blocked state
+        uint64_t readyTick;
+    };
+    struct Patch {
+        int index;
+        uint16_t distance;
+        uint8_t direction;
+    };
+    // a new field, or the tiles a repair changed in one that was published before
+    struct Result {
+        int destination;
+        std::unique_ptr<FlowField> field;
+        vector<Patch> patch;
+        uint64_t readyTick;
+    };
+
+    int width = 0, height = 0;
+    uint64_t tick = 0;
+
+    // simulation thread
+    tx::GridSystem<uint8_t> blocked;
+    std::unordered_map<int, std::unique_ptr<FlowField>> published;
+    std::unordered_set<int> requested;
+    std::deque<uint64_t> pendingReadyTicks;  // of the jobs submitted and not due yet, in order
+    uint64_t publishedJobs = 0;              // jobs due so far
+    bool waitForResults = false;
+
+    // shared
+    std::mutex mx_jobs;
+    std::condition_variable cv_jobs;
+    std::condition_variable cv_finished;
+    std::deque<Job> queuedJobs;
+    vector<Result> finished;  // in request order
+    uint64_t finishedJobs = 0;
+    bool running = false;
+    std::thread coordinator;
+
+    // coordinator thread
+    tx::GridSystem<uint8_t> workerBlocked;       // blocked state as of the job being processed
+    std::map<int, FlowField> working;            // authoritative fields, by destination
+    WavefrontSolver solver;
+    std::unique_ptr<tx::JobSystem> jobSystem;
+    vector<int> seeds, changed, region;
+    vector<uint32_t> stamp;
+    uint32_t currentStamp = 0;
+
+    void submit_impl(const Job& job) {
+        pendingReadyTicks.push_back(job.readyTick);
+        {
+            std::lock_guard<std::mutex> lock(mx_jobs);
+            queuedJobs.push_back(job);
+        }
+        cv_jobs.notify_one();
+    }
+
+    void stop_impl() {
+        if (!coordinator.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mx_jobs);
+            running = false;
+        }
+        cv_jobs.notify_all();
+        coordinator.join();
+    }
+
+    void coordinator_impl() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mx_jobs);
+                cv_jobs.wait(lock, [this]() { return !running || !queuedJobs.empty(); });
+                if (!running) break;
+                job = queuedJobs.front();
+                queuedJobs.pop_front();
+            }
+            vector<Result> results;
+            if (job.type == Job::Type::Build) {
+                FlowField& field = working[job.index];
+                build_impl(field, job.index);
+                results.push_back({ job.index, std::make_unique<FlowField>(field), {}, job.readyTick });
+            } else {
+                workerBlocked.atIndex(job.index) = job.value;
+                for (auto& [destination, field] : working) {
+                    Result& result = results.emplace_back(Result{ destination, nullptr, {}, job.readyTick });
+                    if (job.value) repairBlocked_impl(field, job.index, result.patch);
+                    else           repairUnblocked_impl(field, job.index, result.patch);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mx_jobs);
+                for (Result& result : results) finished.push_back(std::move(result));
+                ++finishedJobs;
+            }
+            cv_finished.notify_one();
+        }
+    }
+
+    void build_impl(FlowField& field, int destination) {
+        field.reset(destination, width, height);
+        seeds.assign(1, destination);
+        changed.clear();
+        solver.relax(field, workerBlocked, seeds, changed, *jobSystem);
+        for (int index = 0; index < field.distance.size(); ++index) {
+            field.computeDirection(index, workerBlocked);
+        }
+    }
+
+    // A tile became blocked: everything downhill of it may now be farther away.
+    // Those tiles are reset and re-relaxed from the untouched tiles around them.
+    void repairBlocked_impl(FlowField& field, int index, vector<Patch>& patch) {
+        ++currentStamp;
+        region.clear();
+        if (field.distance.atIndex(index) != FlowField::Unreachable && index != field.destination) {
+            region.push_back(index);
+            stamp[index] = currentStamp;
+            for (size_t i = 0; i < region.size(); ++i) {
+                int cur = region[i];
+                uint16_t next = field.distance.atIndex(cur) + 1;
+                forNeighbors_impl(cur, [&](int n) {
+                    if (stamp[n] != currentStamp && n != field.destination && field.distance.atIndex(n) == next) {
+                        stamp[n] = currentStamp;
+                        region.push_back(n);
+                    }
+                });
+            }
+        }
+        seeds.clear();
+        for (int r : region) field.distance.atIndex(r) = FlowField::Unreachable;
+        for (int r : region) {
+            forNeighbors_impl(r, [&](int n) {
+                if (stamp[n] != currentStamp && field.distance.atIndex(n) != FlowField::Unreachable) seeds.push_back(n);
+            });
+        }
+        changed.assign(region.begin(), region.end());
+        changed.push_back(index);
+        solver.relax(field, workerBlocked, seeds, changed, *jobSystem);
+        refreshDirections_impl(field, patch);
+    }
+
+    // A tile became free: distances can only shrink, starting from that tile
+    void repairUnblocked_impl(FlowField& field, int index, vector<Patch>& patch) {
+        seeds.clear();
+        changed.assign(1, index);
+        if (field.distance.atIndex(index) != FlowField::Unreachable) seeds.push_back(index);
+        solver.relax(field, workerBlocked, seeds, changed, *jobSystem);
+        refreshDirections_impl(field, patch);
+    }
+
+    // directions depend on the 8 neighbours' distances and blocked state; every tile looked at
+    // goes into patch, the changed ones among them
+    void refreshDirections_impl(FlowField& field, vector<Patch>& patch) {
+        ++currentStamp;
+        for (int index : changed) {
+            int x = index % width, y = index / width;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+                    int n = ny * width + nx;
+                    if (stamp[n] == currentStamp) continue;
+                    stamp[n] = currentStamp;
+                    field.computeDirection(n, workerBlocked);
+                    patch.push_back({ n, field.distance.atIndex(n), field.direction.atIndex(n) });
+                }
+            }
+        }
+    }
+
+    template<class Func>
+    void forNeighbors_impl(int index, Func&& func) const {
+        int x = index % width, y = index / width;
+        if (x + 1 < width)  func(index + 1);
+        if (x > 0)          func(index - 1);
+        if (y + 1 < height) func(index + width);
+        if (y > 0)          func(index - width);
+    }
+};
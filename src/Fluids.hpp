@@ -0,0 +1,84 @@
+#pragma once
+#include "TileNetworks.hpp"
+
+// Fluid networks: pipes, pumps and fluid consumers that touch each other form one run.
+// A run is solved as a single volume: pumps fill it, consumers draw from it and pressure is
+// not simulated per tile, so the per-tick cost is one update per run, not per pipe.
+class FluidSystem {
+public:
+    static constexpr float PipeCapacity = 100.0f;  // units held per tile of a run
+
+    void reinit(int width, int height) {
+        networks.reinit(width, height);
+        capacity.assign(width * height, 0.0f);
+        inflow.assign(width * height, 0.0f);
+        netVolume.assign(width * height, 0.0f);
+        netCapacity.assign(width * height, 0.0f);
+        netInflow.assign(width * height, 0.0f);
+    }
+
+    // Adds a tile to the fluid grid (pumps pass their rate in units per second, everything else 0)
+    void add(int index, float rate) {
+        if (networks.contains(index)) return;
+        capacity[index] = PipeCapacity;
+        inflow[index] = rate;
+        netVolume[index] = 0.0f;
+        netCapacity[index] = PipeCapacity;
+        netInflow[index] = rate;
+        networks.add(index, [this](int into, int from) {
+            netVolume[into]   += netVolume[from];
+            netCapacity[into] += netCapacity[from];
+            netInflow[into]   += netInflow[from];
+        });
+    }
+
+    // The run loses the tile's share of its volume; what is left is split by capacity
+    void remove(int index) {
+        if (!networks.contains(index)) return;
+        int oldRoot = networks.find(index);
+        float remaining = netVolume[oldRoot] * (1.0f - capacity[index] / netCapacity[oldRoot]);
+        float remainingCapacity = netCapacity[oldRoot] - capacity[index];
+        capacity[index] = 0.0f;
+        inflow[index] = 0.0f;
+        for (int root : networks.remove(index)) {
+            float c = 0.0f, f = 0.0f;
+            for (int member : networks.members(root)) {
+                c += capacity[member];
+                f += inflow[member];
+            }
+            netCapacity[root] = c;
+            netInflow[root] = f;
+            netVolume[root] = remainingCapacity > 0.0f ? remaining * c / remainingCapacity : 0.0f;
+        }
+    }
+
+    // Once per tick: O(number of runs)
+    void update(float dt) {
+        for (int root : networks.roots()) {
+            netVolume[root] = std::min(netCapacity[root], netVolume[root] + netInflow[root] * dt);
+        }
+    }
+
+    // Takes up to amount from the tile's run, returns what was taken
+    float draw(int index, float amount) {
+        if (!networks.contains(index)) return 0.0f;
+        float& volume = netVolume[networks.find(index)];
+        float taken = std::min(volume, amount);
+        volume -= taken;
+        return taken;
+    }
+
+    // Fill level of the tile's run (0..1)
+    float fill(int index) {
+        if (!networks.contains(index)) return 0.0f;
+        int root = networks.find(index);
+        return netVolume[root] / netCapacity[root];
+    }
+
+    int networkCount() const { return networks.networkCount(); }
+
+private:
+    TileNetworks networks;
+    vector<float> capacity, inflow;               // per tile contribution
+    vector<float> netVolume, netCapacity, netInflow; // per run, indexed by root tile
+};
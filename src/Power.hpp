@@ -0,0 +1,83 @@
+#pragma once
+#include "TileNetworks.hpp"
+
+// Electric networks: generators, poles and machines that touch each other share one network.
+// Every tile contributes supply and demand (kW); network totals are kept up to date when a
+// contribution changes, so the per-tick work is one division per network.
+class PowerGrid {
+public:
+    void reinit(int width, int height) {
+        networks.reinit(width, height);
+        supply.assign(width * height, 0.0f);
+        demand.assign(width * height, 0.0f);
+        netSupply.assign(width * height, 0.0f);
+        netDemand.assign(width * height, 0.0f);
+        netSatisfaction.assign(width * height, 0.0f);
+    }
+
+    // Adds a tile to the grid (generators pass their output, poles and machines 0)
+    void add(int index, float output) {
+        if (networks.contains(index)) return;
+        supply[index] = output;
+        demand[index] = 0.0f;
+        // the tile starts as its own network and is folded into its neighbours' by the merges
+        netSupply[index] = output;
+        netDemand[index] = 0.0f;
+        int root = networks.add(index, [this](int into, int from) {
+            netSupply[into] += netSupply[from];
+            netDemand[into] += netDemand[from];
+        });
+        netSatisfaction[root] = satisfaction_impl(root);
+    }
+
+    void remove(int index) {
+        if (!networks.contains(index)) return;
+        supply[index] = 0.0f;
+        demand[index] = 0.0f;
+        for (int root : networks.remove(index)) {
+            float s = 0.0f, d = 0.0f;
+            for (int member : networks.members(root)) {
+                s += supply[member];
+                d += demand[member];
+            }
+            netSupply[root] = s;
+            netDemand[root] = d;
+            netSatisfaction[root] = satisfaction_impl(root);
+        }
+    }
+
+    // Machines report their draw when they start or stop working
+    void setDemand(int index, float value) {
+        if (!networks.contains(index) || demand[index] == value) return;
+        netDemand[networks.find(index)] += value - demand[index];
+        demand[index] = value;
+    }
+
+    // Once per tick: O(number of networks)
+    void update() {
+        for (int root : networks.roots()) {
+            netSatisfaction[root] = satisfaction_impl(root);
+        }
+    }
+
+    // Fraction of the requested power the tile's network delivers this tick (0 if not connected)
+    float satisfaction(int index) {
+        return networks.contains(index) ? netSatisfaction[networks.find(index)] : 0.0f;
+    }
+
+    // Totals of the tile's network, kW (0 if not connected)
+    float networkSupply(int index) { return networks.contains(index) ? netSupply[networks.find(index)] : 0.0f; }
+    float networkDemand(int index) { return networks.contains(index) ? netDemand[networks.find(index)] : 0.0f; }
+
+    int networkCount() const { return networks.networkCount(); }
+
+private:
+    TileNetworks networks;
+    vector<float> supply, demand;  // per tile contribution
+    vector<float> netSupply, netDemand, netSatisfaction; // per network, indexed by root tile
+
+    float satisfaction_impl(int root) const {
+        if (netDemand[root] <= tx::epsilon) return 1.0f;
+        return std::min(1.0f, netSupply[root] / netDemand[root]);
+    }
+};
@@ -5,36 +5,14 @@
 #include "TXLib/txmath.hpp"
 #include "TXLib/txmap.hpp"
 #include "TXLib/txjson.hpp"
+#include "TXLib/txsync.hpp"
+#include "TXLib/txarena.hpp"
+#include "World.hpp"
+#include "Snapshot.hpp"
 
 void drawMathLine(const tx::MathLine& line) {
     tx::drawLine(tx::vec2{ -1.0f, tx::findLineY(line, -1.0f) }, tx::vec2{ 1.0f, tx::findLineY(line, 1.0f) });
 }
-void initJsonObject(const std::filesystem::path& filePath, tx::JsonObject& root) {
-    cout << "init json...\n";
-    string str;
-    tx::readWholeFile(filePath, str);
-
-    root = tx::JsonObject{};
-    tx::JsonParser parser;
-    cout << "start init json.\n";
-    parser.parse(str, root);
-    cout << "init json done.\n";
-}
-
-enum class CoordDirection : uint16_t {
-    Right       = 0,        
-    Left        = 1,         
-    Top         = 2,          
-    Bottom      = 3,       
-    TopRight    = 4,     
-    TopLeft     = 5,      
-    BottomLeft  = 6,   
-    BottomRight = 7,
-    None        = 255  // No conveyor on this tile
-};
-constexpr tx::Coord dirToCoord(CoordDirection dir) {
-    return tx::_8wayIncrement[static_cast<int>(dir)];
-}
 
 class BMPFile {
 public:
@@ -217,219 +195,94 @@ RGBMap readBMP(const std::fs::path& fp) {
     return map;
 }
 
-struct Entity {
-    float distance = 0.0f;
-    float size = 1.0f;
-    uint16_t id = 0;
-};
-
-class ConveyorSegment{
-    public:
-
-        void update(float dt, float speed) {
-            if (entities.empty()) return;
-
-            Entity& head = entities.front();
-            head.distance += speed * dt;
-
-            if (head.distance >= length) {
-                if (nextsegment && !nextsegment->isEntryBlocked()) {
-                    Entity transfer = head;
-                    transfer.distance = 0.0f;
-                    nextsegment->entities.push_back(transfer);  // Add to front (head) of next segment
-
-                    entities.pop_front();
-
-                    if (entities.empty()) return;
-                } else {
-                    head.distance = length;
-                }
-            }
-
-            for (size_t i = 1; i < entities.size(); i++) {
-                Entity& current = entities[i];
-                Entity& ahead = entities[i-1];
-
-                current.distance += speed * dt;
-				float spacing = 0.4f;
-                // Limit: current entity's front edge can't pass ahead entity's back edge
-                // Both entities take up 'size' space, so minimum gap is current.size + ahead.size
-                float limit = ahead.distance - ahead.size - current.size - spacing;
 
-                if (current.distance > limit) {
-                    current.distance = std::max(0.0f, limit);  // Clamp to non-negative
-                }
-            }
-        }
-
-        float length = 1.0f;
-        ConveyorSegment* nextsegment = nullptr;
-
-        std::deque<Entity> entities;
-        vector<tx::Coord> WayPoints;
-
-        tx::vec2 p1 = {0, 0}, p2 = {0, 0};
-		tx::vec2 center = { 0, 0 };
-		tx::Coord tilePos = {0, 0};  // Grid position of this segment
-		CoordDirection direction = CoordDirection::Right;  // Output direction of conveyor
-		CoordDirection inputDirection = CoordDirection::None;  // Input direction (where items come from)
-
-        // Check if a new entity of given size can enter (entry is at distance 0)
-        bool isEntryBlocked(float incomingSize = 0.2f) const {
-            if (entities.empty()) return false;
-            const Entity& last = entities.back();  // Entity closest to entry point
-            // The incoming entity at distance=0 with size would collide if:
-            // last.distance - last.size - incomingSize < 0
-            return last.distance < last.size + incomingSize;
-        }
-};
-
-enum class TileType{
-    Space,
-    Ore_Iron,
-    Ore_Copper,
-    Ore_Coal,
-    Ore_Gold
+// A GLFW key, mouse button or cursor event as queued for the simulation thread.
+// Plain data, so a run's input can be recorded and fed back in.
+struct InputEvent {
+    enum class Type : uint8_t { Key, MouseButton, CursorMove };
+    Type type = Type::CursorMove;
+    int code = 0;    // GLFW key or mouse button
+    int action = 0;  // GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT
+    float x = 0.0f, y = 0.0f;  // cursor, window pixels from the top left
+    int windowWidth = 1, windowHeight = 1;
 };
 
-// Extractor: placed on ore tiles, outputs items to adjacent conveyor
-class Extractor {
-public:
-    tx::Coord pos = {0, 0};
-    CoordDirection outputDir = CoordDirection::Right;
-    TileType oreType = TileType::Space;
-    
-    float extractTimer = 0.0f;
-    float extractInterval = 1.0f;  // seconds between extractions
-    
-    // Called each frame with the output conveyor (found by Game class)
-    void update(float dt, ConveyorSegment* outputBelt) {
-        extractTimer += dt;
-        if (extractTimer >= extractInterval) {
-            extractTimer -= extractInterval;
-            
-            if (!outputBelt) return;
-            
-            // Try to output an entity
-            if (!outputBelt->isEntryBlocked(0.2f)) {
-                Entity newEntity;
-                newEntity.distance = 0.0f;
-                newEntity.size = 0.2f;
-                // Set ID based on ore type for sprite selection
-                switch (oreType) {
-                    case TileType::Ore_Coal:   newEntity.id = 0; break;
-                    case TileType::Ore_Copper: newEntity.id = 1; break;
-                    case TileType::Ore_Gold:   newEntity.id = 2; break;
-                    case TileType::Ore_Iron:   newEntity.id = 3; break;
-                    default: newEntity.id = 0; break;
-                }
-                outputBelt->entities.push_back(newEntity);
-            }
-        }
-    }
-};
-
-class Tile {
-public:
-
-    void update() {
-        switch(m_type){
-
-        }
-    }
-
-    void setType(TileType in) { m_type = in; }
-    // void setExtracter() {}
-    void setPos(const tx::Coord& in) { m_pos = in; }
-    TileType        type() const { return m_type; }
-    const tx::Coord& pos() const {return m_pos;}
-    bool operator==(const Tile& other) const { return this->m_type == other.m_type; }
-    bool operator!=(const Tile& other) const { return this->m_type != other.m_type; }
-
-    void setConveyor(ConveyorSegment* ptr) {conveyer = ptr; }
-    ConveyorSegment* getConveyor() const {return conveyer; }
-
-private:
-    TileType m_type = TileType::Space;
-    tx::Coord m_pos;
-    ConveyorSegment* conveyer = nullptr;
-};
-
-
-// tile amount: 64
+// Renders a World with immediate-mode GL and turns input into placements.
+// update() runs on the simulation thread and is the only code touching the World: GLFW callbacks
+// only queue their events (input()), which the simulation handles at the start of the next tick,
+// and the renderer draws the RenderSnapshot published after each tick.
 class Game {
     using id = uint16_t;
 public:
-    Game() : 
-        rde([](){
-            std::random_device rrde;
-            std::mt19937 rde_{rrde()};
-            return rde_;
-        }())
+    // background: where the throughput analysis is solved, between frames
+    explicit Game(tx::BackgroundScheduler& in_background) :
+        background(in_background),
+        cfg([](){
+            tx::JsonObject root;
+            initJsonObject("./config/config.json", root);
+            return root;
+        }()),
+        world(cfg),
+        assetRandom(world.randomStream(World::RandomStream::Render))
     {
-        cout << "start init" << endl;
-
-        tiles.reinit(MapSize);
-        tiles.foreach([](Tile& in, const tx::Coord& pos) { in.setPos(pos); });
-        
-        // Initialize conveyor direction grid with None (no conveyor)
-        conveyorDirections.reinit(MapSize);
-        conveyorDirections.foreach([](CoordDirection& dir, const tx::Coord&) { dir = CoordDirection::None; });
-        
-        initJsonObject("./config/config.json", cfg);
+        auto tileTypes = std::make_shared<tx::GridSystem<TileType>>(MapSize);
+        tileTypes->foreach([this](TileType& type, const tx::Coord& pos) { type = world.getTiles().at(pos).type(); });
+        simTileTypes = shownTileTypes = std::move(tileTypes);
+        publishSnapshot_impl();
 
         cout << "start init assets..." << endl;
         initAssets();
         cout << "init assets done." << endl;
-        genOreTiles_impl();
         initGroundTileMap();
     }
 
+    // simulation thread
     void update() {
-        updateConveyor(0.016f);
-        updateExtractors(0.016f);
+        tickArena.reset();
+        processInput_impl();
+        updateViewport_impl();
+        world.update();
+        vector<tx::Coord> exhausted = world.takeExhaustedDeposits();
+        if (!exhausted.empty()) {
+            // snapshots still being drawn keep the old grid
+            auto tileTypes = std::make_shared<tx::GridSystem<TileType>>(*simTileTypes);
+            for (const tx::Coord& pos : exhausted) tileTypes->at(pos) = TileType::Space;
+            simTileTypes = std::move(tileTypes);
+        }
         
         // Update conveyor animation
-        conveyorAnimTimer += 0.016f;
-        if (conveyorAnimTimer >= 1.0f / CONVEYOR_ANIM_SPEED) {
-            conveyorAnimTimer -= 1.0f / CONVEYOR_ANIM_SPEED;
-            conveyorAnimFrame = (conveyorAnimFrame + 1) % CONVEYOR_ANIM_FRAMES;
-        }
+        animTime = std::fmod(animTime + world.getTickTime(), CONVEYOR_ANIM_FRAMES / CONVEYOR_ANIM_SPEED);
+        publishSnapshot_impl();
     }
-    
-    void updateExtractors(float dt) {
-        for (auto& extractor : extractors) {
-            // Find adjacent conveyor dynamically
-            ConveyorSegment* outputBelt = findAdjacentConveyor(extractor.pos);
-            extractor.update(dt, outputBelt);
+
+    // Input thread (GLFW callbacks): queues event for the next tick. A cursor move only replaces
+    // the pending one and is queued in front of the next key or button, or picked up by the next
+    // tick, so a burst of moves takes one slot. Keys and buttons are never dropped: when the queue
+    // is full they go to an overflow list, in order.
+    void input(const InputEvent& event) {
+        std::lock_guard<std::mutex> lock(mx_input);
+        if (event.type == InputEvent::Type::CursorMove) {
+            pendingCursor = event;
+            return;
         }
-    }
-    
-    ConveyorSegment* findAdjacentConveyor(const tx::Coord& pos) {
-        static const tx::Coord offsets[] = {
-            {1, 0}, {-1, 0}, {0, 1}, {0, -1}
-        };
-        
-        for (const auto& offset : offsets) {
-            tx::Coord neighborPos = pos + offset;
-            
-            if (neighborPos.x() >= 0 && neighborPos.x() < MapSize &&
-                neighborPos.y() >= 0 && neighborPos.y() < MapSize) {
-                ConveyorSegment* neighbor = tiles.at(neighborPos).getConveyor();
-                if (neighbor) {
-                    return neighbor;
-                }
-            }
+        if (pendingCursor) {
+            queueInput_impl(*pendingCursor);
+            pendingCursor.reset();
         }
-        return nullptr;
+        queueInput_impl(event);
     }
-    
-    // Set placement mode: 0 = Conveyor, 1 = Extractor
-    void setPlacementMode(int mode) {
-        placementMode = (mode == 0) ? PlacementMode::Conveyor : PlacementMode::Extractor;
+    // Before the simulation starts: recorder sees every event the simulation handles, with its tick
+    void setInputRecorder(std::function<void(uint64_t, const InputEvent&)> recorder) {
+        inputRecorder = std::move(recorder);
     }
 
-    void render(){
+    float getTickRate() const { return 1.0f / world.getTickTime(); }
+    // Any thread: while time warp is on, a snapshot is only captured once the render thread took the
+    // last one, frames are few and far between then
+    void setTimeWarp(bool in_timeWarp) { timeWarp.store(in_timeWarp, std::memory_order_relaxed); }
+
+    // render thread: draws the newest snapshot, alpha of the way towards the next tick
+    void render(float alpha = 1.0f){
         // // tx::Coord cur{0, 0};
         // // for(; cur.y() < MapSize; cur.moveY(1)){
         // //   for(; cur.x() < MapSize; cur.moveX(1)){
@@ -445,18 +298,33 @@ public:
         // //   return tx::getBWColor(!(in.type() == TileType::Space));
         // // });
 
+        frameArena.reset();
+        const RenderSnapshot& snap = snapshots.read();
+        // everything is drawn a tick behind, so positions are interpolated instead of extrapolated
+        float behind = 1.0f - std::clamp(alpha, 0.0f, 1.0f);
+        int animFrame = animFrame_impl(snap.animTime - behind * snap.tickTime);
+        if (snap.tileTypes != shownTileTypes) {
+            // deposits ran out since the last frame
+            std::shared_ptr<const tx::GridSystem<TileType>> before = std::exchange(shownTileTypes, snap.tileTypes);
+            for (World::TileIndex i : oreTiles) {
+                if (before->atIndex(i) != shownTileTypes->atIndex(i)) retileGround_impl(shownTileTypes->coord(i));
+            }
+        }
+
         // 1. LAYER 1: The Ground (Draw this FIRST so it's at the back)
         renderGroundTiles();
 
         // 2. LAYER 2: The Resources
-        for (id i : ores) {
-            renderOres_impl(tiles.atIndex(i));
+        for (World::TileIndex i : oreTiles) {
+            TileType type = shownTileTypes->atIndex(i);
+            if (type == TileType::Space) continue; // exhausted deposit
+            renderOres_impl(shownTileTypes->coord(i), type);
         }
 
         // 3. LAYER 3: The Conveyor Belts (Draw these ON TOP of the ground)
-        for (const auto& seg : conveyorBelts) {
+        for (const RenderSnapshot::BeltView& seg : snap.belts) {
             // Draw conveyor sprite based on direction
-            tx::vec2 renderPos = getRenderPos(seg.tilePos);
+            tx::vec2 renderPos = getRenderPos(seg.pos);
             
             // Helper to check if direction is horizontal
             auto isHorizontal = [](CoordDirection d) {
@@ -467,7 +335,9 @@ public:
             };
             
             // Determine sprite based on input/output directions
-            string spriteName;
+            static const string CornerUp = "conveyor_corner_up", CornerDown = "conveyor_corner_down";
+            static const string Horizontal = "conveyor_horizontal", Vertical = "conveyor_vertical";
+            const string* spriteName = &Horizontal;
             bool reverseAnim = false;  // Whether to play animation backwards
             bool flipX = false;  // Mirror sprite horizontally
             bool flipY = false;  // Mirror sprite vertically
@@ -483,9 +353,9 @@ public:
                 
                 // Determine which corner sprite based on vertical component
                 if (seg.direction == CoordDirection::Top || seg.inputDirection == CoordDirection::Bottom) {
-                    spriteName = "conveyor_corner_up";
+                    spriteName = &CornerUp;
                 } else {
-                    spriteName = "conveyor_corner_down";
+                    spriteName = &CornerDown;
                 }
                 
                 // Flip sprite X and reverse animation when output goes LEFT or input is from LEFT
@@ -498,84 +368,146 @@ public:
                 // Straight piece - NO sprite flipping, only animation reversal
                 switch (seg.direction) {
                     case CoordDirection::Left:
-                        spriteName = "conveyor_horizontal";
+                        spriteName = &Horizontal;
                         reverseAnim = true;  // Reverse animation for left
                         break;
                     case CoordDirection::Right:
-                        spriteName = "conveyor_horizontal";
+                        spriteName = &Horizontal;
                         // Normal animation for right
                         break;
                     case CoordDirection::Top:
-                        spriteName = "conveyor_vertical";
+                        spriteName = &Vertical;
                         // Normal animation for up
                         break;
                     case CoordDirection::Bottom:
-                        spriteName = "conveyor_vertical";
+                        spriteName = &Vertical;
                         reverseAnim = true;  // Reverse animation for down
                         break;
                     default:
-                        spriteName = "conveyor_horizontal";
+                        spriteName = &Horizontal;
                         break;
                 }
             }
             
             // Get animation frame sprite
-            const vector<id>& frames = assetIndexMap.at(spriteName);
+            const vector<id>& frames = assetIndexMap.at(*spriteName);
             // When reversed, play animation backwards
             int frameIndex = reverseAnim ? 
-                (CONVEYOR_ANIM_FRAMES - 1 - (conveyorAnimFrame % frames.size())) : 
-                (conveyorAnimFrame % frames.size());
+                (CONVEYOR_ANIM_FRAMES - 1 - (animFrame % frames.size())) : 
+                (animFrame % frames.size());
             id spriteId = frames[frameIndex % frames.size()];
             
             // Draw sprite (with flip for corners only)
             tx::PixelEngine::drawRGBmapSquareFlipped(resources.at(spriteId), renderPos, TileSize, flipX, flipY);
 
-            // Draw Entities (Items) - smooth interpolation along segment
-            for (const auto& entity : seg.entities) {
-                float t = entity.distance / seg.length;
-                tx::vec2 pos = seg.p1 + (seg.p2 - seg.p1) * t;
-
-				if (t < 0.5f) {
-                    // First half: Move from P1 to Center
-                    // Map t (0.0 to 0.5) to local (0.0 to 1.0)
-                    float localT = t * 2.0f; 
-                    pos = seg.p1 + (seg.center - seg.p1) * localT;
-                } else {
-                    // Second half: Move from Center to P2
-                    // Map t (0.5 to 1.0) to local (0.0 to 1.0)
-                    float localT = (t - 0.5f) * 2.0f;
-                    pos = seg.center + (seg.p2 - seg.center) * localT;
-                }
+            // Draw Entities (Items), positioned along the segment by the snapshot
+            for (int i = seg.itemBegin; i < seg.itemEnd; ++i) {
+                const RenderSnapshot::ItemView& item = snap.items[i];
 
                 // Draw ore sprite centered on position
                 float itemSize = TileSize * 0.6f;
-                tx::vec2 itemPos = pos - tx::vec2{ itemSize / 2, itemSize / 2 };
+                tx::vec2 itemPos = getRenderPos(item.pos - item.step * behind) - tx::vec2{ itemSize / 2, itemSize / 2 };
                 
-                // Use entity.id to pick ore type (cycle through available ores)
-                static const string oreNames[] = {"coal", "copper", "gold", "iron"};
-                const string& oreName = oreNames[entity.id % 4];
-                const vector<id>& oreFrames = assetIndexMap.at(oreName);
-                id oreSpriteId = oreFrames[entity.id % oreFrames.size()];
+                // Use the item id to pick the item sprite: ores 0-3, ingots 4-7
+                static const string itemNames[] = {"coal", "copper", "gold", "iron", "coal_ingot", "copper_ingot", "gold_ingot", "iron_ingot"};
+                const string& itemName = itemNames[item.id % 8];
+                const vector<id>& oreFrames = assetIndexMap.at(itemName);
+                id oreSpriteId = oreFrames[item.id % oreFrames.size()];
                 
                 tx::PixelEngine::drawRGBmapSquare(resources.at(oreSpriteId), itemPos, itemSize);
             }
         }
 
         // 4. LAYER 4: Extractors
-        for (const auto& extractor : extractors) {
-            tx::vec2 renderPos = getRenderPos(extractor.pos);
+        for (const tx::Coord& extractor : snap.extractors) {
+            tx::vec2 renderPos = getRenderPos(extractor);
             
             // Get animated extractor sprite (9 frames)
             const vector<id>& frames = assetIndexMap.at("extractor");
-            int frameIndex = conveyorAnimFrame % frames.size();  // Use conveyor anim timer
+            int frameIndex = animFrame % frames.size();  // Use conveyor anim timer
             id spriteId = frames[frameIndex];
             
             tx::PixelEngine::drawRGBmapSquare(resources.at(spriteId), renderPos, TileSize);
         }
 
-        // 5. LAYER 5: The Ghost Preview (UI always goes LAST/ON TOP)
-        if (isDragging) {
-            auto ghostPath = calculatePath(dragStart, dragEnd);
+        // 5. LAYER 5: Storage and inserters
+        for (const RenderSnapshot::StorageView& storage : snap.storages) {
+            // storage frames show how full it is
+            const vector<id>& frames = assetIndexMap.at("storage");
+            int frameIndex = std::min<int>(storage.total * frames.size() / storage.capacity, frames.size() - 1);
+            tx::PixelEngine::drawRGBmapSquare(resources.at(frames[frameIndex]), getRenderPos(storage.pos), TileSize);
+        }
+        for (const RenderSnapshot::InserterView& inserter : snap.inserters) {
+            tx::vec2 bottomLeft = getRenderPos(inserter.pos);
+            tx::vec2 center = bottomLeft + tx::vec2{ TileSize / 2, TileSize / 2 };
+            tx::glColorRGB(tx::DarkGray);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.3f, TileSize * 0.3f }, TileSize * 0.4f, TileSize * 0.4f);
+
+            // arm swings from the pickup side to the drop side
+            tx::Coord d = dirToCoord(inserter.dir);
+            tx::vec2 dirVec = { (float)d.x(), (float)d.y() };
+            float arm = std::max(0.0f, inserter.arm - inserter.armStep * behind);
+            tx::vec2 hand = center + dirVec * (TileSize * 0.5f * (2.0f * arm - 1.0f));
+            tx::glColorRGB(tx::Yellow);
+            tx::drawLine(center, hand, TileSize * 0.05f);
+        }
+
+        // Power buildings: crafters animate while smelting, dimmed when their network is short of power
+        for (const RenderSnapshot::CrafterView& crafter : snap.crafters) {
+            tx::vec2 renderPos = getRenderPos(crafter.pos);
+            if (crafter.refinery) {
+                // refinery_idle is a single frame, refinery cycles while refining
+                const vector<id>& frames = assetIndexMap.at(crafter.working ? "refinery" : "refinery_idle");
+                tx::PixelEngine::drawRGBmapSquare(resources.at(frames[animFrame % frames.size()]), renderPos, TileSize);
+            } else {
+                const vector<id>& frames = assetIndexMap.at("crafter");
+                int frameIndex = crafter.working ? animFrame % frames.size() : 0;
+                tx::PixelEngine::drawRGBmapSquare(resources.at(frames[frameIndex]), renderPos, TileSize);
+            }
+            if (crafter.lowPower) {
+                tx::glColorRGB(tx::Red);
+                tx::drawRectP(renderPos + tx::vec2{ TileSize * 0.8f, TileSize * 0.8f }, TileSize * 0.15f, TileSize * 0.15f);
+            }
+        }
+        for (const tx::Coord& generator : snap.generators) {
+            tx::vec2 bottomLeft = getRenderPos(generator);
+            tx::glColorRGB(tx::SteelBlue);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.1f, TileSize * 0.1f }, TileSize * 0.8f, TileSize * 0.8f);
+            tx::glColorRGB(tx::Yellow);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.4f, TileSize * 0.25f }, TileSize * 0.2f, TileSize * 0.5f);
+        }
+        for (const tx::Coord& pole : snap.poles) {
+            tx::vec2 bottomLeft = getRenderPos(pole);
+            tx::glColorRGB(tx::Brown);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.4f, TileSize * 0.1f }, TileSize * 0.2f, TileSize * 0.8f);
+        }
+
+        // Fluid buildings: pipes show the fill level of their run
+        for (const RenderSnapshot::PipeView& pipe : snap.pipes) {
+            tx::vec2 bottomLeft = getRenderPos(pipe.pos);
+            tx::glColorRGB(tx::Gray);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.3f, TileSize * 0.3f }, TileSize * 0.4f, TileSize * 0.4f);
+            tx::glColorRGB(tx::SkyBlue);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.35f, TileSize * 0.35f }, TileSize * 0.3f, TileSize * 0.3f * pipe.level);
+        }
+        for (const tx::Coord& pump : snap.pumps) {
+            tx::vec2 bottomLeft = getRenderPos(pump);
+            tx::glColorRGB(tx::Navy);
+            tx::drawRectP(bottomLeft + tx::vec2{ TileSize * 0.15f, TileSize * 0.15f }, TileSize * 0.7f, TileSize * 0.7f);
+            tx::glColorRGB(tx::SkyBlue);
+            tx::drawCircle(bottomLeft + tx::vec2{ TileSize / 2, TileSize / 2 }, TileSize * 0.2f);
+        }
+
+        // Drones fly above every building; carrying drones are drawn brighter
+        float droneRadius = DroneSwarm::Radius * TileSize;
+        for (const RenderSnapshot::DroneView& drone : snap.drones) {
+            tx::glColorRGB(drone.carrying ? tx::Orange : tx::LightGray);
+            tx::drawCircle(getRenderPos(drone.pos - drone.step * behind), droneRadius);
+        }
+
+        // 6. LAYER 6: The Ghost Preview (UI always goes LAST/ON TOP)
+        if (snap.dragging) {
+            auto ghostPath = World::calculatePath(snap.dragStart, snap.dragEnd, frameArena.resource());
             for (const auto& step : ghostPath) {
                 tx::vec2 bottomLeft = getRenderPos(step.pos);
                 tx::vec2 topLeft = bottomLeft + tx::vec2{ 0.0f, TileSize };  // Move up to get top-left
@@ -594,41 +526,52 @@ public:
     }
 
 
-
 private:
-    // runtime data
-    std::list<ConveyorSegment> conveyorBelts;
-    std::list<Extractor> extractors;
-    
+    tx::BackgroundScheduler& background;
+    tx::JsonObject cfg;
+    World world;
+
+    // input thread -> simulation thread
+    static constexpr size_t InputQueueSize = 256;  // events per tick before the overflow list is used
+    tx::SpscQueue<InputEvent, InputQueueSize> inputQueue;
+    std::mutex mx_input;                       // taken by every input(), by the simulation once per tick
+    vector<InputEvent> inputOverflow;          // newer than anything in inputQueue
+    std::optional<InputEvent> pendingCursor;   // newer than anything queued
+    vector<InputEvent> lateInput;              // simulation thread: taken under mx_input, handled after
+    std::function<void(uint64_t, const InputEvent&)> inputRecorder;
+    // transient allocations, released at the start of the next tick / frame
+    tx::BumpArena tickArena;   // simulation thread
+    tx::BumpArena frameArena;  // render thread
+    // simulation thread -> render thread
+    tx::TripleBuffer<RenderSnapshot> snapshots;
+    std::atomic<bool> timeWarp{ false };
+    bool coarseView = false;  // simulation thread: the world was told nothing is watched (updateViewport_impl)
+    std::shared_ptr<const tx::GridSystem<TileType>> simTileTypes;    // simulation thread, newest tile types
+    std::shared_ptr<const tx::GridSystem<TileType>> shownTileTypes;  // render thread, what the ground map shows
+    vector<World::TileIndex> oreTiles = world.getOres();
+
+    // input state, simulation thread
+    tx::Coord routeStart = { -1, -1 };  // first storage picked in DroneRoute mode
+    static constexpr int DronesPerRoute = 10;
+
     // Placement mode
-    enum class PlacementMode { Conveyor, Extractor };
+    enum class PlacementMode { Conveyor, Extractor, Inserter, Storage, Crafter, Generator, Pole, Refinery, Pipe, Pump, DroneRoute };
     PlacementMode placementMode = PlacementMode::Conveyor;
-    
-    struct BuildStep {
-        tx::Coord pos;
-        CoordDirection dir;
-    };
+    CoordDirection placementDir = CoordDirection::Right;
+    uint8_t placementSides = Extractor::AllSides;
 
     // Animation
-    float conveyorAnimTimer = 0.0f;
-    int conveyorAnimFrame = 0;
+    float animTime = 0.0f;  // simulation thread, wraps every CONVEYOR_ANIM_FRAMES frames
     static constexpr int CONVEYOR_ANIM_FRAMES = 4;
     static constexpr float CONVEYOR_ANIM_SPEED = 8.0f;  // frames per second
 
-    // Grid tracking conveyor directions for each tile (None = no conveyor)
-    tx::GridSystem<CoordDirection> conveyorDirections;
-
-    bool isDragging = false;
+    bool isDragging = false;  // conveyor drag in progress, the renderer gets it with the snapshot
     tx::Coord dragStart = {0, 0};
     tx::Coord dragEnd = {0, 0};
 
-    tx::GridSystem<Tile> tiles;
-    vector<id> ores;
-
 private:
     // config
-    tx::JsonObject cfg;
-    int MapSize = 16;
+    int MapSize = world.getMapSize();
     float TileSize = 2.0f / MapSize;
     inline static const tx::KVMap<TileType, string> assetNameMap = {
         {TileType::Ore_Coal,   "coal"},
@@ -639,87 +582,10 @@ private:
     tx::KVMap<string, vector<id>> assetIndexMap; // { name, vector<index> }
     vector<RGBMap> resources; // all bitmaps
     tx::GridSystem<id> groundTileMap;
+    tx::GridSystem<int> groundClasses;  // groundClass_impl per tile, so only changed tiles get a new variant
 private:
     // utility
-    std::mt19937 rde;
-    std::uniform_int_distribution<int> dist_map{0, MapSize - 1};
-    std::uniform_int_distribution<int> dist_np{-1, 1};
-    
-    void updateConveyor(float dt) {
-        for (auto& segment: conveyorBelts) {
-            float speed = 2.0f;
-            segment.update(dt, speed);
-        }
-    }
-
-    void setOreTile_impl(const tx::Coord& pos, TileType type) {
-        if(!valid_impl(pos)) return;
-        tiles.at(pos).setType(type);
-        int index = tiles.index(pos);
-        ores.push_back(index);
-    }
-
-
-
-    void genOreTiles_impl() {
-        genOre_impl("PolicyCommon", TileType::Ore_Coal);
-    }
-    void genOre_impl(const string& policy, TileType type) {
-        const tx::JsonObject& policyCfg = cfg["OreGeneration"][policy].get<tx::JsonObject>();
-        tx::Bitmap circle;
-        float radius = [&](){
-            float r = policyCfg["radius"].get<float>();
-            tx::GridCircle gc{r};
-            gc.getBitMap(tx::CoordOrigin, circle);
-            return r;
-        }();
-        tx::Bitmap surroundingCircle;
-        float surroundingRadius = [&](){
-            float sr = policyCfg["surroundingClusterRadius"].get<float>();
-            tx::GridCircle gc{sr};
-            gc.getBitMap(tx::CoordOrigin, surroundingCircle);
-            return sr;
-        }();
-        std::uniform_int_distribution<int> dist_offset{
-            policyCfg["surroundingClusterOffsetMin"].get<int>(),
-            policyCfg["surroundingClusterOffsetMax"].get<int>()};
-        
-        int clusterAmount = policyCfg["clusterAmount"].get<int>();
-        for(int i = 0; i < clusterAmount; ++i){
-            tx::Coord center = getRandCoord_impl();
-            int surroundingClusterAmount = policyCfg["surroundingClusterAmount"].get<int>();
-            //cout << surroundingClusterAmount << endl;
-            vector<tx::Coord> surroundingCenters(surroundingClusterAmount);
-            for(tx::Coord& i : surroundingCenters){
-                i = center.offset(dist_np(rde) * dist_offset(rde), dist_np(rde) * dist_offset(rde));
-            }
-
-            auto setOreTiles = [&](const tx::Coord& pos, const tx::Bitmap& map){
-                for(const tx::Coord& i : map){
-                    setOreTile_impl(i + pos, type);
-                }
-            };
-            
-            setOreTiles(center, circle);
-            for(const tx::Coord& i : surroundingCenters){
-                setOreTiles(i, surroundingCircle);
-            }
-        }
-        std::sort(ores.begin(), ores.end());
-        ores.erase(std::unique(ores.begin(), ores.end()), ores.end());
-    }
-
-
-    tx::Coord getRandCoord_impl() {
-        return tx::Coord{dist_map(rde), dist_map(rde)};
-    }
-    bool valid_impl(const tx::Coord& in) const {
-        return tx::inRange(in, tx::CoordOrigin, tx::Coord{MapSize});
-    }
-
-
-
-    
+    tx::Random assetRandom;  // split per tile: a tile keeps its variant for a given world seed
 
     // render ********************************
 
@@ -747,10 +613,18 @@ private:
     tx::vec2 getRenderPos(const tx::Coord& in) const {
         return tx::toVec2(in) * TileSize - 1.0f;
     }
-    void renderOres_impl(const Tile& tile) {
+    // world positions (belt items, drones) are in tile units
+    tx::vec2 getRenderPos(const tx::vec2& in) const {
+        return in * TileSize - 1.0f;
+    }
+    int animFrame_impl(float time) const {
+        int frame = static_cast<int>(std::floor(time * CONVEYOR_ANIM_SPEED)) % CONVEYOR_ANIM_FRAMES;
+        return frame < 0 ? frame + CONVEYOR_ANIM_FRAMES : frame;
+    }
+    void renderOres_impl(const tx::Coord& pos, TileType type) {
         tx::PixelEngine::drawRGBmap(
-            resources.at(getRandAsset(assetNameMap.at(tile.type()))),
-            getRenderPos(tile.pos()), TileSize);
+            resources.at(getRandAsset(assetNameMap.at(type), pos)),
+            getRenderPos(pos), TileSize);
     }   
 
 
@@ -797,11 +671,11 @@ private:
     //  }
     // }
 
-    // get asset variant of a asset
-    id getRandAsset(const string& assetName) {
+    // get asset variant of a asset, the same one every time for the same tile
+    id getRandAsset(const string& assetName, const tx::Coord& pos) {
         const vector<id>& variantPaths = assetIndexMap.at(assetName); // all variant paths for an asset
-        std::uniform_int_distribution<int> dist{0, variantPaths.size() - 1};
-        return variantPaths[dist(rde)];
+        tx::Random tileRandom = assetRandom.split(static_cast<uint64_t>(pos.y()) * MapSize + pos.x());
+        return variantPaths[tileRandom.uniform(0, static_cast<int>(variantPaths.size()) - 1)];
     }
 
 
@@ -810,44 +684,45 @@ private:
     // must be after all ore gen
     void initGroundTileMap(){
         groundTileMap.reinit(MapSize);
-        
-        // tiles.foreach([](const Tile& in) {
-        //  if(in.type() != TileType::Space){
-        //      cout << in.pos() << endl;
-        //  }
-        // });
-
-        for(id i : ores){ // ores are 1, grass are 0
-            groundTileMap.atIndex(i) = 1;
-        }
-        tx::Bitmap edge; edge.reserve(tx::sq(MapSize) * 0.4);
-        groundTileMap.foreach([&](id& in, const tx::Coord& pos) { // find edge
-            if(in) return;
-            for(uint8_t i = 0; i < 8; ++i){
-                tx::Coord adjacent = pos + tx::_8wayIncrement[i];
-                if(valid_impl(adjacent) && groundTileMap.at(adjacent)){
-                    edge.emplace_back(pos);
-                    break;
-                }
-            }
-        });
-
+        groundClasses.reinit(MapSize);
         groundTileMap.foreach([&](id& in, const tx::Coord& pos) {
-            if(in){
-                in = getRandAsset("rock");
-            } else {
-                in = getRandAsset("grass");
-            }
+            groundClasses.at(pos) = groundClass_impl(pos);
+            in = groundAsset_impl(groundClasses.at(pos), pos);
         });
-
-        for(const tx::Coord& i : edge){
-            groundTileMap.at(i) = assetIndexMap.at("groundEdge")[static_cast<int>(findGroundTileDir(i))];
+    }
+    // A deposit ran out: only its 3x3 neighbourhood is re-tiled (a tile's ground class depends
+    // only on its 8 neighbours), unchanged tiles keep their variant
+    void retileGround_impl(const tx::Coord& pos) {
+        for (int i = 0; i < 9; ++i) {
+            tx::Coord p = pos.offset(i % 3 - 1, i / 3 - 1);
+            if (!shownTileTypes->valid(p)) continue;
+            int after = groundClass_impl(p);
+            if (after == groundClasses.at(p)) continue;
+            groundClasses.at(p) = after;
+            groundTileMap.at(p) = groundAsset_impl(after, p);
         }
     }
+    bool isRock_impl(const tx::Coord& in) {
+        return shownTileTypes->valid(in) && shownTileTypes->at(in) != TileType::Space;
+    }
+    // 0 = grass, 1 = rock (ore), 2 + CoordDirection = grass edge bordering rock
+    int groundClass_impl(const tx::Coord& pos) {
+        if (isRock_impl(pos)) return 1;
+        for (uint8_t i = 0; i < 8; ++i) {
+            if (isRock_impl(pos + tx::_8wayIncrement[i])) {
+                return 2 + static_cast<int>(findGroundTileDir(pos));
+            }
+        }
+        return 0;
+    }
+    id groundAsset_impl(int groundClass, const tx::Coord& pos) {
+        if (groundClass == 0) return getRandAsset("grass", pos);
+        if (groundClass == 1) return getRandAsset("rock", pos);
+        return assetIndexMap.at("groundEdge")[groundClass - 2];
+    }
     CoordDirection findGroundTileDir(const tx::Coord& tile) {
         auto checkNoexcept = [&](const tx::Coord& in) -> bool {
-            if(!valid_impl(in)) return 0;
-            return groundTileMap.at(in);
+            return isRock_impl(in);
         };
         if(checkNoexcept(tile + dirToCoord(CoordDirection::Top   )) && checkNoexcept(tile + dirToCoord(CoordDirection::Left ))) return CoordDirection::TopLeft;
         if(checkNoexcept(tile + dirToCoord(CoordDirection::Top   )) && checkNoexcept(tile + dirToCoord(CoordDirection::Right))) return CoordDirection::TopRight;
@@ -857,6 +732,11 @@ private:
         if(checkNoexcept(tile + dirToCoord(CoordDirection::Bottom))) return CoordDirection::Bottom;
         if(checkNoexcept(tile + dirToCoord(CoordDirection::Left  ))) return CoordDirection::Left;
         if(checkNoexcept(tile + dirToCoord(CoordDirection::Right ))) return CoordDirection::Right;
+        // only a diagonal neighbour is rock
+        if(checkNoexcept(tile + dirToCoord(CoordDirection::TopLeft   ))) return CoordDirection::TopLeft;
+        if(checkNoexcept(tile + dirToCoord(CoordDirection::TopRight  ))) return CoordDirection::TopRight;
+        if(checkNoexcept(tile + dirToCoord(CoordDirection::BottomLeft))) return CoordDirection::BottomLeft;
+        return CoordDirection::BottomRight;
     }
 
     void renderGroundTiles(){
@@ -869,146 +749,216 @@ private:
         });
     }
 
+private:
+    // Steady-state layout analysis: the simulation thread takes the layout's production graph,
+    // background solves and prints it a slice at a time
+    void printThroughput() {
+        auto analysis = std::make_shared<ThroughputAnalysis>(world.buildThroughputAnalysis());
+        background.post([analysis]() {
+            if (!analysis->step()) return false;
+            analysis->report.print(cout);
+            return true;
+        });
+    }
 
-    void initTestConveyors() {
-        placeConveyor({2, 2}, CoordDirection::Right);
-        placeConveyor({3, 2}, CoordDirection::Right);
-
-        if (tiles.at({2, 2}).getConveyor()) {
-            Entity item;
-            item.distance = 0.0f;
-            item.size = 0.2f;
-            item.id = 1;
-            tiles.at({2,2}).getConveyor()->entities.push_back(item);
+    // Set placement mode: 0 = Conveyor, 1 = Extractor, 2 = Inserter, 3 = Storage,
+    // 4 = Crafter, 5 = Generator, 6 = Power pole, 7 = Refinery, 8 = Pipe, 9 = Pump, 10 = Drone route
+    void setPlacementMode(int mode) {
+        switch (mode) {
+            case 0:  placementMode = PlacementMode::Conveyor;  break;
+            case 1:  placementMode = PlacementMode::Extractor; break;
+            case 2:  placementMode = PlacementMode::Inserter;  break;
+            case 3:  placementMode = PlacementMode::Storage;   break;
+            case 4:  placementMode = PlacementMode::Crafter;   break;
+            case 5:  placementMode = PlacementMode::Generator; break;
+            case 6:  placementMode = PlacementMode::Pole;      break;
+            case 7:  placementMode = PlacementMode::Refinery;  break;
+            case 8:  placementMode = PlacementMode::Pipe;      break;
+            case 9:  placementMode = PlacementMode::Pump;      break;
+            case 10: placementMode = PlacementMode::DroneRoute; routeStart = tx::Coord{ -1, -1 }; break;
+            default: break;
+        }
+    }
+    // Rotate the direction used for placing inserters and extractor outputs (counter-clockwise)
+    void rotatePlacement() {
+        switch (placementDir) {
+            case CoordDirection::Right:  placementDir = CoordDirection::Top;    break;
+            case CoordDirection::Top:    placementDir = CoordDirection::Left;   break;
+            case CoordDirection::Left:   placementDir = CoordDirection::Bottom; break;
+            default:                     placementDir = CoordDirection::Right;  break;
         }
     }
 
-	void placeConveyor(tx::Coord pos, CoordDirection dir) {
-        if (!valid_impl(pos)) return;
-
-        // Register direction
-        conveyorDirections.at(pos) = dir;
-
-        conveyorBelts.emplace_back();
-        ConveyorSegment* newSeg = &conveyorBelts.back();
-        newSeg->length = 1.0f;
-        newSeg->tilePos = pos;  // Store tile position
-        newSeg->direction = dir;  // Store direction for sprite selection
-
-        // Calculate Geometry
-        tx::vec2 tileCorner = getRenderPos(pos);
-        float halfSize = TileSize / 2.0f;
-        tx::vec2 center = tileCorner + tx::vec2{ halfSize, halfSize };
-        newSeg->center = center; // Store center
-
-        tx::Coord delta = dirToCoord(dir);
-        tx::vec2 dirVec = { (float)delta.x(), (float)delta.y() };
-
-        // Default: Straight line (Center-Dir -> Center+Dir)
-        newSeg->p1 = center - (dirVec * halfSize);
-        newSeg->p2 = center + (dirVec * halfSize);
-
-        tiles.at(pos).setConveyor(newSeg);
+    void onMouseEvent(float mouseX, float mouseY, bool isDown, bool isRelease, int windowWidth, int windowHeight) {
+        tx::Coord gridPos = screenToGrid_impl(mouseX, mouseY, windowWidth, windowHeight);
 
-        // --- 1. BACKWARD SNAP (Inputs) ---
-        // Look for neighbors that point AT us. Snap our start to their end.
-        for(int i = 0; i < 4; ++i) { // Check NESW
-            tx::Coord checkPos = pos + dirToCoord(static_cast<CoordDirection>(i));
-            if (!valid_impl(checkPos)) continue;
-            
-            // Is there a conveyor?
-            if (conveyorDirections.at(checkPos) == CoordDirection::None) continue;
-            
-            ConveyorSegment* prev = tiles.at(checkPos).getConveyor();
-            if (!prev) continue;
+        // --- LOGIC ---
+        if (placementMode == PlacementMode::Conveyor) {
+            // Conveyor placement mode: drag to place conveyors
+            if (isDown && !isDragging) {
+                isDragging = true;
+                dragStart = gridPos;
+            }
 
-            // Does it point to us?
-            CoordDirection prevDir = conveyorDirections.at(checkPos);
-            tx::Coord outputOffset = dirToCoord(prevDir);
-            
-            if (checkPos + outputOffset == pos) {
-                // YES! It feeds us.
-                // 1. Snap our Start (p1) to their End (p2)
-                newSeg->p1 = prev->p2;
-                
-                // 2. Link them to us
-                prev->nextsegment = newSeg;
-                
-                // 3. Record our input direction (opposite of where the prev segment is)
-                // If prev is to our left, input comes from left, etc.
-                newSeg->inputDirection = static_cast<CoordDirection>(i);
-                
-                // (We break after the first input found to keep it simple)
-                break; 
+            if (isDragging) {
+                dragEnd = gridPos;
             }
-        }
 
-        // --- 2. FORWARD SNAP (Outputs) ---
-        // Look at where we are pointing.
-        tx::Coord targetPos = pos + delta;
-        if (valid_impl(targetPos)) {
-            ConveyorSegment* target = tiles.at(targetPos).getConveyor();
-            if (target) {
-                // We feed them.
-                newSeg->nextsegment = target;
-                
-                // AUTO-CORNER LOGIC:
-                // Snap their Start (p1) to our End (p2).
-                // This dynamically turns a straight belt into a corner if we side-load it!
-                target->p1 = newSeg->p2;
-                
-                // Update target's input direction (opposite of our direction = direction we're coming from)
-                // We're at 'pos', target is at 'targetPos', so target's input comes from direction opposite to 'dir'
-                // Actually, the input direction is where we are relative to target
-                // We placed at 'pos', and we point to 'targetPos', so from target's perspective, input comes from 'pos'
-                // That means input direction is the opposite of 'dir'
-                switch (dir) {
-                    case CoordDirection::Right: target->inputDirection = CoordDirection::Left; break;
-                    case CoordDirection::Left: target->inputDirection = CoordDirection::Right; break;
-                    case CoordDirection::Top: target->inputDirection = CoordDirection::Bottom; break;
-                    case CoordDirection::Bottom: target->inputDirection = CoordDirection::Top; break;
-                    default: break;
+            if (isRelease && isDragging) {
+                for (const auto& step : World::calculatePath(dragStart, dragEnd, tickArena.resource())) {
+                    world.placeConveyor(step.pos, step.dir);
+                }
+                isDragging = false;
+            }
+        } else if (placementMode == PlacementMode::Extractor) {
+            // Extractor placement mode: click on ore tile to place extractor
+            if (isRelease) {
+                world.placeExtractor(gridPos, placementDir, placementSides);
+            }
+        } else if (placementMode == PlacementMode::Inserter) {
+            if (isRelease) {
+                world.placeInserter(gridPos, placementDir);
+            }
+        } else if (placementMode == PlacementMode::Storage) {
+            if (isRelease) {
+                world.placeStorage(gridPos);
+            }
+        } else if (placementMode == PlacementMode::Crafter) {
+            if (isRelease) {
+                world.placeCrafter(gridPos);
+            }
+        } else if (placementMode == PlacementMode::Generator) {
+            if (isRelease) {
+                world.placeGenerator(gridPos);
+            }
+        } else if (placementMode == PlacementMode::Pole) {
+            if (isRelease) {
+                world.placePole(gridPos);
+            }
+        } else if (placementMode == PlacementMode::Refinery) {
+            if (isRelease) {
+                world.placeRefinery(gridPos);
+            }
+        } else if (placementMode == PlacementMode::Pipe) {
+            if (isRelease) {
+                world.placePipe(gridPos);
+            }
+        } else if (placementMode == PlacementMode::Pump) {
+            if (isRelease) {
+                world.placePump(gridPos);
+            }
+        } else if (placementMode == PlacementMode::DroneRoute) {
+            // first click picks the source storage, second click the target
+            if (isRelease) {
+                if (routeStart.x() < 0) {
+                    if (world.valid(gridPos) && world.getTiles().at(gridPos).getStorage()) routeStart = gridPos;
+                } else {
+                    world.addDroneRoute(routeStart, gridPos, DronesPerRoute);
+                    routeStart = tx::Coord{ -1, -1 };
                 }
             }
         }
     }
 
-    std::vector<BuildStep> calculatePath(tx::Coord start, tx::Coord end) {
-        std::vector<BuildStep> path;
-        int dx = end.x() - start.x();
-        int dy = end.y() - start.y();
-
-        tx::Coord current = start;
+    // Right click: removes the building under the cursor
+    void onRemoveEvent(float mouseX, float mouseY, int windowWidth, int windowHeight) {
+        world.removeBuilding(screenToGrid_impl(mouseX, mouseY, windowWidth, windowHeight));
+    }
 
-        int xSteps = std::abs(dx);
-        int ySteps = std::abs(dy);
-        
-        CoordDirection xDir = (dx >= 0) ? CoordDirection::Right : CoordDirection::Left;
-        CoordDirection yDir = (dy >= 0) ? CoordDirection::Top : CoordDirection::Bottom;
+    // Toggle between extractors outputting to every side and only to the placement direction
+    void toggleExtractorSides() {
+        placementSides = (placementSides == Extractor::AllSides)
+            ? static_cast<uint8_t>(1 << static_cast<int>(placementDir))
+            : Extractor::AllSides;
+    }
 
-        // Handle horizontal movement - all horizontal tiles point in the horizontal direction
-        for (int i = 0; i < xSteps; i++) {
-            path.push_back({current, xDir});
-            current = current + dirToCoord(xDir);
+    void onKey_impl(int key) {
+        switch (key) {
+            case GLFW_KEY_1: setPlacementMode(0);  break;  // Conveyor
+            case GLFW_KEY_2: setPlacementMode(1);  break;  // Extractor
+            case GLFW_KEY_3: setPlacementMode(2);  break;  // Inserter
+            case GLFW_KEY_4: setPlacementMode(3);  break;  // Storage
+            case GLFW_KEY_5: setPlacementMode(4);  break;  // Crafter
+            case GLFW_KEY_6: setPlacementMode(5);  break;  // Generator
+            case GLFW_KEY_7: setPlacementMode(6);  break;  // Power pole
+            case GLFW_KEY_8: setPlacementMode(7);  break;  // Refinery
+            case GLFW_KEY_9: setPlacementMode(8);  break;  // Pipe
+            case GLFW_KEY_0: setPlacementMode(9);  break;  // Pump
+            case GLFW_KEY_D: setPlacementMode(10); break;  // Drone route: click source storage, then target
+            case GLFW_KEY_R: rotatePlacement();      break;  // Inserter / extractor output direction
+            case GLFW_KEY_O: toggleExtractorSides(); break;  // Extractor outputs: all sides / placement direction only
+            case GLFW_KEY_T: printThroughput();      break;  // Steady-state layout analysis
+            default: break;
         }
+    }
 
-        // Handle vertical movement - all vertical tiles point in the vertical direction
-        for (int i = 0; i < ySteps; ++i) {
-            path.push_back({current, yDir});
-            current = current + dirToCoord(yDir);
+    void handleInput_impl(const InputEvent& event) {
+        switch (event.type) {
+            case InputEvent::Type::Key:
+                if (event.action == GLFW_PRESS) onKey_impl(event.code);
+                break;
+            case InputEvent::Type::MouseButton:
+                if (event.code == GLFW_MOUSE_BUTTON_LEFT) {
+                    onMouseEvent(event.x, event.y, event.action == GLFW_PRESS, event.action == GLFW_RELEASE, event.windowWidth, event.windowHeight);
+                } else if (event.code == GLFW_MOUSE_BUTTON_RIGHT && event.action == GLFW_PRESS) {
+                    onRemoveEvent(event.x, event.y, event.windowWidth, event.windowHeight);
+                }
+                break;
+            case InputEvent::Type::CursorMove:
+                onMouseEvent(event.x, event.y, false, false, event.windowWidth, event.windowHeight);
+                break;
         }
+    }
+    // The whole map is on screen, so every chunk is simulated every tick, except under time warp:
+    // frames are few and far between then, and per-tick motion is not seen (World::setViewport)
+    void updateViewport_impl() {
+        bool coarse = timeWarp.load(std::memory_order_relaxed);
+        if (coarse == coarseView) return;
+        coarseView = coarse;
+        if (coarse) world.setViewport({ 0, 0 }, { -1, -1 });
+        else        world.setViewport({ 0, 0 }, { MapSize - 1, MapSize - 1 });
+    }
 
-        // If start == end, place a single tile
-        if (path.empty()) {
-            path.push_back({start, CoordDirection::Right});
+    // input thread, under mx_input: keeps the order once the overflow list is in use
+    void queueInput_impl(const InputEvent& event) {
+        if (inputOverflow.empty() && inputQueue.push(event)) return;
+        inputOverflow.push_back(event);
+    }
+
+    // Handles the events since the last tick, in order: the queue without locking, then under
+    // mx_input what was queued meanwhile, the overflow list and the pending cursor move
+    void processInput_impl() {
+        InputEvent event;
+        while (inputQueue.pop(event)) handleRecorded_impl(event);
+        lateInput.clear();
+        {
+            std::lock_guard<std::mutex> lock(mx_input);
+            while (inputQueue.pop(event)) lateInput.push_back(event);
+            lateInput.insert(lateInput.end(), inputOverflow.begin(), inputOverflow.end());
+            inputOverflow.clear();
+            if (pendingCursor) lateInput.push_back(*pendingCursor);
+            pendingCursor.reset();
         }
+        for (const InputEvent& late : lateInput) handleRecorded_impl(late);
+    }
+    void handleRecorded_impl(const InputEvent& event) {
+        if (inputRecorder) inputRecorder(world.getTick(), event);
+        handleInput_impl(event);
+    }
 
-        return path;
+    void publishSnapshot_impl() {
+        if (timeWarp.load(std::memory_order_relaxed) && snapshots.unread()) return;
+        RenderSnapshot& snap = snapshots.back();
+        snap.capture(world);
+        snap.animTime = animTime;
+        snap.tileTypes = simTileTypes;
+        snap.dragging = isDragging;
+        snap.dragStart = dragStart;
+        snap.dragEnd = dragEnd;
+        snapshots.publish();
     }
 
-public:
-    void onMouseEvent(float mouseX, float mouseY, bool isDown, bool isRelease, int windowWidth, int windowHeight) {
-        
+    tx::Coord screenToGrid_impl(float mouseX, float mouseY, int windowWidth, int windowHeight) const {
         // --- 1. CONVERT MOUSE TO NDC (Normalized Device Coordinates) ---
         // OpenGL NDC: X from -1 (left) to +1 (right), Y from -1 (bottom) to +1 (top)
         // Mouse coords: (0,0) at top-left, Y increases downward
@@ -1029,56 +979,7 @@ public:
         int gridX = std::clamp((int)std::floor(gridXf), 0, MapSize - 1);
         int gridY = std::clamp((int)std::floor(gridYf), 0, MapSize - 1);
         
-        tx::Coord gridPos = { gridX, gridY };
-
-        // --- 3. LOGIC ---
-        if (placementMode == PlacementMode::Conveyor) {
-            // Conveyor placement mode: drag to place conveyors
-            if (isDown && !isDragging) {
-                isDragging = true;
-                dragStart = gridPos;
-            }
-
-            if (isDragging) {
-                dragEnd = gridPos;
-            }
-
-            if (isRelease && isDragging) {
-                auto path = calculatePath(dragStart, dragEnd);
-                for (const auto& step : path) {
-                    placeConveyor(step.pos, step.dir);
-                }
-                isDragging = false;
-            }
-        } else if (placementMode == PlacementMode::Extractor) {
-            // Extractor placement mode: click on ore tile to place extractor
-            if (isRelease) {
-                placeExtractor(gridPos);
-            }
-        }
-    }
-    
-    void placeExtractor(const tx::Coord& pos) {
-        Tile& tile = tiles.at(pos);
-        
-        // Can only place extractors on ore tiles
-        if (tile.type() == TileType::Space) {
-            return;  // Not an ore tile
-        }
-        
-        // Check if there's already an extractor here
-        for (const auto& ext : extractors) {
-            if (ext.pos == pos) {
-                return;  // Already has extractor
-            }
-        }
-        
-        // Create the extractor - it will dynamically find adjacent conveyors
-        Extractor newExtractor;
-        newExtractor.pos = pos;
-        newExtractor.oreType = tile.type();
-        
-        extractors.push_back(newExtractor);
+        return tx::Coord{ gridX, gridY };
     }
 };
 
@@ -0,0 +1,127 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include "Behavior.hpp"
+
+// Numeric signals that buildings write and read, wired through combinators.
+// Nothing is evaluated in a full pass: writing a new value to an input marks the nodes reading
+// it, and update() recomputes only those, lowest rank first, so a node is computed at most once
+// per tick and only after all of its inputs. A setup whose inputs hold steady costs nothing.
+// A node's inputs must exist before it is added, so wiring can not form a loop.
+class SignalNetwork {
+public:
+    using Node = int;
+    static constexpr Node None = -1;
+
+    enum class Op : uint8_t {
+        Input,     // written by a building or set()
+        Sum,       // sum of the inputs plus the constant
+        Multiply,  // product of the inputs times the constant (1 unless given)
+        Greater,   // 1 if the sum of the inputs is greater than the constant, else 0
+        Less,      // 1 if it is less
+        Equal      // 1 if it is equal
+    };
+
+    Node addInput(int value = 0) {
+        Node node = add_impl(Op::Input, 0, 0);
+        written[node] = values[node] = value;
+        return node;
+    }
+    // without a constant, Multiply uses 1 and everything else 0
+    Node addCombinator(Op op, const vector<Node>& inputs, std::optional<int> constant = std::nullopt) {
+        int rank = 0;
+        for (Node input : inputs) rank = std::max(rank, ranks[input] + 1);
+        Node node = add_impl(op, constant.value_or(op == Op::Multiply ? 1 : 0), rank);
+        nodeInputs[node] = inputs;
+        for (Node input : inputs) dependents[input].push_back(node);
+        values[node] = compute_impl(node);
+        return node;
+    }
+
+    // Input nodes only, false for combinators: readers see the value after the next update()
+    bool set(Node node, int value) {
+        if (ops[node] != Op::Input) return false;
+        if (written[node] == value) return true;
+        written[node] = value;
+        markDirty_impl(node);
+        return true;
+    }
+
+    int value(Node node) const { return values[node]; }
+    Op op(Node node) const { return ops[node]; }
+    // behaviors parked until the node's value changes
+    WaitList& watchers(Node node) { return nodeWatchers[node]; }
+
+    // Once per tick: recomputes the nodes whose inputs changed since the last call and wakes
+    // the behaviors watching the ones that changed value
+    void update(vector<BehaviorHandle>& ready) {
+        evaluated = 0;
+        while (!dirty.empty()) {
+            Node node = dirty.top().second;
+            dirty.pop();
+            isDirty[node] = false;
+            ++evaluated;
+            int result = compute_impl(node);
+            if (result == values[node]) continue;
+            values[node] = result;
+            nodeWatchers[node].wakeInto(ready);
+            for (Node dependent : dependents[node]) markDirty_impl(dependent);
+        }
+    }
+
+    int size() const { return static_cast<int>(values.size()); }
+    int lastEvaluated() const { return evaluated; }  // nodes recomputed by the last update()
+
+private:
+    vector<Op> ops;
+    vector<int> constants;
+    vector<int> ranks;       // 0 for inputs, one more than the highest input rank otherwise
+    vector<int> values;      // what readers see
+    vector<int> written;     // Input nodes: value set since the last update
+    vector<vector<Node>> nodeInputs;
+    vector<vector<Node>> dependents;
+    std::deque<WaitList> nodeWatchers;  // deque: behaviors keep pointers to the lists they park on
+    vector<uint8_t> isDirty;
+    std::priority_queue<std::pair<int, Node>, vector<std::pair<int, Node>>, std::greater<>> dirty;  // (rank, node)
+    int evaluated = 0;
+
+    Node add_impl(Op op, int constant, int rank) {
+        ops.push_back(op);
+        constants.push_back(constant);
+        ranks.push_back(rank);
+        values.push_back(0);
+        written.push_back(0);
+        nodeInputs.emplace_back();
+        dependents.emplace_back();
+        nodeWatchers.emplace_back();
+        isDirty.push_back(false);
+        return static_cast<Node>(values.size()) - 1;
+    }
+
+    void markDirty_impl(Node node) {
+        if (isDirty[node]) return;
+        isDirty[node] = true;
+        dirty.push({ ranks[node], node });
+    }
+
+    // 64-bit while combining, saturated to int: large counts must not wrap into small ones
+    int compute_impl(Node node) const {
+        int64_t sum = 0;
+        for (Node input : nodeInputs[node]) sum += values[input];
+        int64_t result = 0;
+        switch (ops[node]) {
+            case Op::Input:    return written[node];
+            case Op::Sum:      result = sum + constants[node]; break;
+            case Op::Multiply: {
+                result = constants[node];
+                for (Node input : nodeInputs[node]) {
+                    result = std::clamp<int64_t>(result * values[input], INT_MIN, INT_MAX);
+                }
+                break;
+            }
+            case Op::Greater:  result = sum > constants[node];  break;
+            case Op::Less:     result = sum < constants[node];  break;
+            case Op::Equal:    result = sum == constants[node]; break;
+        }
+        return static_cast<int>(std::clamp<int64_t>(result, INT_MIN, INT_MAX));
+    }
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include "World.hpp"
+
+// What the renderer draws, copied out of the World after a tick.
+// The simulation thread fills one snapshot while the render thread draws another (tx::TripleBuffer),
+// so a slow frame never holds up a tick and a slow tick never holds up a frame. Snapshots are
+// reused: once their vectors have grown, capture() only copies.
+// Moving things also carry how far they moved during the tick (step), so frames drawn between two
+// ticks can place them at pos - step * (1 - alpha), alpha being the share of the next tick elapsed.
+struct RenderSnapshot {
+    struct BeltView {
+        tx::Coord pos;
+        CoordDirection direction;
+        CoordDirection inputDirection;
+        int itemBegin, itemEnd;  // range in items
+    };
+    struct ItemView {
+        tx::vec2 pos;  // tile units
+        tx::vec2 step;
+        uint16_t id;
+    };
+    struct StorageView {
+        tx::Coord pos;
+        int total, capacity;
+    };
+    struct InserterView {
+        tx::Coord pos;
+        CoordDirection dir;
+        float arm;  // 0 = over the pickup side, 1 = over the drop side
+        float armStep;
+    };
+    struct CrafterView {
+        tx::Coord pos;
+        bool refinery;
+        bool working;
+        bool lowPower;  // working on a network that is short of power
+    };
+    struct PipeView {
+        tx::Coord pos;
+        float level;
+    };
+    struct DroneView {
+        tx::vec2 pos;
+        tx::vec2 step;
+        bool carrying;
+    };
+
+    int tick = 0;
+    float tickTime = 0.0f;
+    float animTime = 0.0f;  // seconds into the looping building animations
+    // tile types, shared by every snapshot until a deposit runs out
+    std::shared_ptr<const tx::GridSystem<TileType>> tileTypes;
+    // conveyor drag in progress (Game input state), drawn as a ghost path
+    bool dragging = false;
+    tx::Coord dragStart, dragEnd;
+
+    vector<BeltView> belts;
+    vector<ItemView> items;
+    vector<tx::Coord> extractors;
+    vector<StorageView> storages;
+    vector<InserterView> inserters;
+    vector<CrafterView> crafters;
+    vector<tx::Coord> generators;
+    vector<tx::Coord> poles;
+    vector<PipeView> pipes;
+    vector<tx::Coord> pumps;
+    vector<DroneView> drones;
+
+    // not const: network lookups compress their paths
+    void capture(World& world) {
+        tick = world.getTick();
+        tickTime = world.getTickTime();
+
+        belts.clear();
+        items.clear();
+        for (const ConveyorSegment& seg : world.getConveyors()) {
+            int itemBegin = static_cast<int>(items.size());
+            BeltView& belt = belts.emplace_back(BeltView{ seg.tilePos, seg.direction, seg.inputDirection, itemBegin, itemBegin });
+            if (!world.detailed(seg.tilePos)) continue;  // out of view, items are not where they would be
+            // items follow p1 -> center -> p2, so corners bend through the tile centre;
+            // before p1 (last tick's position of an item that changed segment) the first half is extended
+            auto posAt = [&seg](float distance) {
+                float t = distance / seg.length;
+                return t < 0.5f
+                    ? seg.p1 + (seg.center - seg.p1) * (t * 2.0f)
+                    : seg.center + (seg.p2 - seg.center) * ((t - 0.5f) * 2.0f);
+            };
+            for (const Entity& entity : seg.entities) {
+                tx::vec2 pos = posAt(entity.distance);
+                items.push_back({ pos, pos - posAt(entity.prevDistance), entity.id });
+            }
+            belt.itemEnd = static_cast<int>(items.size());
+        }
+
+        extractors.clear();
+        for (const Extractor& extractor : world.getExtractors()) extractors.push_back(extractor.pos);
+        storages.clear();
+        for (const Storage& storage : world.getStorages()) storages.push_back({ storage.pos, storage.total, storage.capacity });
+
+        inserters.clear();
+        for (const Inserter& inserter : world.getInserters()) {
+            float arm = 0.0f, armStep = 0.0f;
+            if (inserter.state == Inserter::State::Swing) {
+                float swingTicks = std::max(1.0f, std::ceil(inserter.swingTime / tickTime));
+                arm = 1.0f - (inserter.swingEndTick - tick) / swingTicks;
+                armStep = 1.0f / swingTicks;
+            } else if (inserter.state == Inserter::State::WaitTarget) {
+                arm = 1.0f;
+            }
+            inserters.push_back({ inserter.pos, inserter.dir, arm, armStep });
+        }
+
+        crafters.clear();
+        for (const Crafter& crafter : world.getCrafters()) {
+            bool lowPower = crafter.working() && world.powerSatisfaction(crafter.pos) < 1.0f;
+            crafters.push_back({ crafter.pos, crafter.kind == Crafter::Kind::Refinery, crafter.working(), lowPower });
+        }
+        generators.clear();
+        for (const Generator& generator : world.getGenerators()) generators.push_back(generator.pos);
+        poles.clear();
+        for (const PowerPole& pole : world.getPoles()) poles.push_back(pole.pos);
+        pipes.clear();
+        for (const Pipe& pipe : world.getPipes()) pipes.push_back({ pipe.pos, world.fluidFill(pipe.pos) });
+        pumps.clear();
+        for (const Pump& pump : world.getPumps()) pumps.push_back(pump.pos);
+
+        drones.clear();
+        for (const Drone& drone : world.getDrones()) drones.push_back({ drone.pos, drone.vel * tickTime, drone.carrying });
+    }
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include "TXLib/txjob.hpp"
+
+// Per-tick phases as a dependency graph.
+// Every phase declares the data it reads and writes (one bit per kind of data). A phase depends on
+// the earlier phases it conflicts with (write/write, read/write), so conflicting phases keep the
+// order they were added in and everything else runs side by side. The edges are worked out once,
+// when the graph changes; a tick only submits one job per phase.
+// A phase can run every interval ticks instead of every tick. Phases sharing an interval get
+// different offsets where possible, so slow phases take turns rather than all landing on one tick.
+class TaskGraph {
+public:
+    using Resources = uint32_t;
+    static constexpr Resources AllResources = ~Resources{ 0 };
+    // below this much work per tick (ms) waking the workers costs more than it saves
+    static constexpr double ParallelThreshold = 0.2;
+
+    int add(const string& name, Resources reads, Resources writes, std::function<void()> func, int interval = 1) {
+        phases.push_back({ name, reads | writes, writes, std::move(func), std::max(interval, 1) });
+        built = false;
+        return static_cast<int>(phases.size()) - 1;
+    }
+
+    // Runs every phase due at tick once and returns when all are done.
+    // Light ticks run the phases in order on the calling thread.
+    void run(tx::JobSystem& jobs, uint64_t tick = 0) {
+        if (!built) build_impl();
+        if (lastTotal < ParallelThreshold) {
+            for (Phase& phase : phases) {
+                if (due_impl(phase, tick)) runPhase_impl(phase);
+            }
+            lastTotal = averageTotal_impl();
+            return;
+        }
+        handles.resize(phases.size());
+        for (size_t i = 0; i < phases.size(); ++i) {
+            const vector<int>& deps = phases[i].deps;
+            bool due = due_impl(phases[i], tick);
+            // a phase not due passes on what it would have waited for to the phases after it
+            if (!due && deps.size() <= 1) {
+                handles[i] = deps.empty() ? nullptr : handles[deps[0]];
+                continue;
+            }
+            depHandles.clear();
+            for (int dep : deps) depHandles.push_back(handles[dep]);
+            if (due) handles[i] = jobs.submit([this, i]() { runPhase_impl(phases[i]); }, depHandles);
+            else     handles[i] = jobs.submit([]() {}, depHandles);
+        }
+        jobs.wait(handles);
+        lastTotal = averageTotal_impl();
+    }
+
+    // Phases that must finish before phase starts
+    const vector<int>& dependencies(int phase) {
+        if (!built) build_impl();
+        return phases[phase].deps;
+    }
+
+    int size() const { return static_cast<int>(phases.size()); }
+    const string& name(int phase) const { return phases[phase].name; }
+    double lastDuration(int phase) const { return phases[phase].lastDuration; }  // ms, of its last run
+    int interval(int phase) const { return phases[phase].interval; }
+    int offset(int phase) {
+        if (!built) build_impl();
+        return phases[phase].offset;
+    }
+
+    void print(std::ostream& os) {
+        if (!built) build_impl();
+        for (const Phase& phase : phases) {
+            os << "[TaskGraph]: " << phase.name << " " << phase.lastDuration << " ms";
+            if (phase.interval > 1) os << " every " << phase.interval << " ticks (+" << phase.offset << ")";
+            if (!phase.deps.empty()) {
+                os << ", after";
+                for (int dep : phase.deps) os << " " << phases[dep].name;
+            }
+            os << "\n";
+        }
+    }
+
+private:
+    struct Phase {
+        string name;
+        Resources reads = 0;   // includes writes
+        Resources writes = 0;
+        std::function<void()> func;
+        int interval = 1;  // ticks
+        int offset = 0;    // runs at ticks where (tick + offset) % interval == 0
+        vector<int> deps = {};
+        double lastDuration = 0.0;
+    };
+    vector<Phase> phases;
+    bool built = false;
+    double lastTotal = 0.0;            // ms per tick on average, slow phases count by their share
+    vector<tx::JobHandle> handles;     // this tick's job per phase
+    vector<tx::JobHandle> depHandles;
+
+    // Depend on the closest earlier phase per conflict only: an older conflicting phase is
+    // already ordered before that one when it conflicts with it too
+    void build_impl() {
+        for (size_t j = 0; j < phases.size(); ++j) {
+            Phase& phase = phases[j];
+            phase.deps.clear();
+            Resources writesToOrder = phase.writes;   // go after earlier reads and writes of this data
+            Resources readsToOrder = phase.reads;     // go after earlier writes of this data
+            for (size_t k = j; k-- > 0 && (writesToOrder || readsToOrder);) {
+                const Phase& earlier = phases[k];
+                Resources conflict = (writesToOrder & earlier.reads) | (readsToOrder & earlier.writes);
+                if (!conflict) continue;
+                phase.deps.push_back(static_cast<int>(k));
+                writesToOrder &= ~earlier.writes;
+                readsToOrder &= ~earlier.writes;
+            }
+            std::reverse(phase.deps.begin(), phase.deps.end());
+        }
+        assignOffsets_impl();
+        built = true;
+    }
+
+    // In order of adding, each slow phase takes the first offset shared with the fewest earlier
+    // slow phases; two phases meet on some tick when their offsets agree modulo gcd of intervals
+    void assignOffsets_impl() {
+        for (size_t j = 0; j < phases.size(); ++j) {
+            Phase& phase = phases[j];
+            phase.offset = 0;
+            if (phase.interval == 1) continue;
+            int fewest = INT_MAX;
+            for (int offset = 0; offset < phase.interval; ++offset) {
+                int meets = 0;
+                for (size_t k = 0; k < j; ++k) {
+                    const Phase& earlier = phases[k];
+                    if (earlier.interval == 1) continue;
+                    int common = std::gcd(phase.interval, earlier.interval);
+                    if ((offset - earlier.offset) % common == 0) ++meets;
+                }
+                if (meets < fewest) {
+                    fewest = meets;
+                    phase.offset = offset;
+                }
+            }
+        }
+    }
+
+    static bool due_impl(const Phase& phase, uint64_t tick) {
+        return (tick + phase.offset) % phase.interval == 0;
+    }
+    double averageTotal_impl() const {
+        double total = 0.0;
+        for (const Phase& phase : phases) total += phase.lastDuration / phase.interval;
+        return total;
+    }
+
+    static double runPhase_impl(Phase& phase) {
+        tx::Time::Timer timer;
+        phase.func();
+        phase.lastDuration = timer.duration();
+        return phase.lastDuration;
+    }
+};
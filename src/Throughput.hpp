@@ -0,0 +1,210 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+
+// Offline steady-state analysis of a factory layout.
+// The production graph is built once from the layout and solved as a max-flow problem,
+// so a design can be checked without ticking the simulation.
+
+// Directed graph with float capacities (items per second), solved with Dinic's algorithm
+class FlowNetwork {
+public:
+    static constexpr float Infinite = std::numeric_limits<float>::max();
+
+    struct Edge {
+        int to;
+        int rev;         // index of the reverse edge in adjacency[to]
+        float capacity;  // remaining capacity
+        float original;  // capacity before solving (0 for reverse edges)
+    };
+
+    int addNode() {
+        adjacency.emplace_back();
+        return static_cast<int>(adjacency.size()) - 1;
+    }
+
+    // returns a handle { from, index in adjacency[from] } to query the edge after solving
+    std::pair<int, int> addEdge(int from, int to, float capacity) {
+        int index = static_cast<int>(adjacency[from].size());
+        adjacency[from].push_back(Edge{ to,   static_cast<int>(adjacency[to].size()), capacity, capacity });
+        adjacency[to  ].push_back(Edge{ from, index,                                   0.0f,     0.0f     });
+        return { from, index };
+    }
+
+    float maxFlow(int source, int sink) {
+        while (step(source, sink)) {}
+        return total;
+    }
+
+    // One step of maxFlow(): a level graph build or one augmenting path, so a large network can
+    // be solved a little at a time. Returns false once the flow is maximal.
+    bool step(int source, int sink) {
+        if (!leveled) {
+            // the last failed level build marks exactly the nodes reachable in the residual graph
+            if (!buildLevels_impl(source, sink)) return false;
+            cursor.assign(adjacency.size(), 0);
+            leveled = true;
+        }
+        float pushed = push_impl(source, sink, Infinite);
+        total += pushed;
+        if (pushed == 0.0f) leveled = false;
+        return true;
+    }
+    float flowSoFar() const { return total; }
+
+    // after maxFlow(): true if the node is on the source side of the minimum cut
+    bool onSourceSide(int node) const { return level[node] >= 0; }
+
+    const Edge& edge(const std::pair<int, int>& handle) const { return adjacency[handle.first][handle.second]; }
+    float flow(const std::pair<int, int>& handle) const {
+        const Edge& e = edge(handle);
+        return e.original - e.capacity;
+    }
+    int size() const { return static_cast<int>(adjacency.size()); }
+
+private:
+    vector<vector<Edge>> adjacency;
+    vector<int> level;
+    vector<int> cursor;
+    vector<Edge*> path;
+    float total = 0.0f;
+    bool leveled = false;  // level graph built and not blocked yet
+
+    bool buildLevels_impl(int source, int sink) {
+        level.assign(adjacency.size(), -1);
+        std::queue<int> frontier;
+        level[source] = 0;
+        frontier.push(source);
+        while (!frontier.empty()) {
+            int node = frontier.front(); frontier.pop();
+            for (const Edge& e : adjacency[node]) {
+                if (e.capacity > tx::epsilon && level[e.to] < 0) {
+                    level[e.to] = level[node] + 1;
+                    frontier.push(e.to);
+                }
+            }
+        }
+        return level[sink] >= 0;
+    }
+
+    // iterative blocking-flow step; belt chains can be thousands of nodes deep, so no recursion
+    float push_impl(int source, int sink, float limit) {
+        path.clear();
+        int node = source;
+        while (node != sink) {
+            bool advanced = false;
+            for (int& i = cursor[node]; i < static_cast<int>(adjacency[node].size()); ++i) {
+                const Edge& e = adjacency[node][i];
+                if (e.capacity > tx::epsilon && level[e.to] == level[node] + 1) {
+                    path.push_back(&adjacency[node][i]);
+                    node = e.to;
+                    advanced = true;
+                    break;
+                }
+            }
+            if (advanced) continue;
+            // dead end: prune the node and retreat one step
+            level[node] = -1;
+            if (path.empty()) return 0.0f;
+            path.pop_back();
+            node = path.empty() ? source : path.back()->to;
+            ++cursor[node];
+        }
+        float pushed = limit;
+        for (const Edge* e : path) pushed = std::min(pushed, e->capacity);
+        for (Edge* e : path) {
+            e->capacity -= pushed;
+            adjacency[e->to][e->rev].capacity += pushed;
+        }
+        return pushed;
+    }
+};
+
+// Result of World::analyzeThroughput()
+struct ThroughputReport {
+    enum class Limit {
+        Extraction, // extractor mining rate
+        Belt,       // conveyor segment item rate
+        Inserter,   // one item per swing
+        Crafter     // ore smelted per second at full power
+    };
+    struct Bottleneck {
+        Limit limit;
+        tx::Coord pos;     // tile of the limiting building
+        float capacity;    // items per second
+    };
+
+    float throughput = 0.0f;      // items per second delivered to storages
+    float extractionRate = 0.0f;  // items per second all extractors could mine
+    int extractorCount = 0;
+    int segmentCount = 0;
+    int inserterCount = 0;
+    int crafterCount = 0;
+    int storageCount = 0;
+    vector<Bottleneck> bottlenecks; // saturated edges of the minimum cut
+    double analysisTime = 0.0;      // ms
+
+    void print(std::ostream& os) const {
+        os << "[Analysis]: " << extractorCount << " extractors, " << segmentCount << " conveyor segments, "
+           << inserterCount << " inserters, " << crafterCount << " crafters, " << storageCount << " storages ("
+           << analysisTime << "ms)\n";
+        os << "[Analysis]: steady-state throughput " << throughput << " items/s of " << extractionRate << " items/s extracted\n";
+        for (const Bottleneck& b : bottlenecks) {
+            os << "[Analysis]:   bottleneck " << name_impl(b.limit) << " at " << b.pos << ": " << b.capacity << " items/s\n";
+        }
+    }
+
+private:
+    static const char* name_impl(Limit limit) {
+        switch (limit) {
+            case Limit::Extraction: return "extractor";
+            case Limit::Belt:       return "conveyor ";
+            case Limit::Inserter:   return "inserter ";
+            case Limit::Crafter:    return "crafter  ";
+        }
+        return "";
+    }
+};
+
+// analyzeThroughput() in steps: the network is built from the layout in one go (World::
+// buildThroughputAnalysis), then solved a step at a time, so a large layout can be analyzed in
+// the background without holding up a tick or a frame.
+struct ThroughputAnalysis {
+    using EdgeList = vector<std::pair<std::pair<int, int>, tx::Coord>>;
+
+    FlowNetwork net;
+    int source = 0, sink = 0;
+    EdgeList extractorEdges, beltEdges, inserterEdges, crafterEdges;
+    ThroughputReport report;  // counts and extraction rate filled in when built
+
+    // a few solver steps; true once the report is complete
+    bool step(int steps = 64) {
+        if (done) return true;
+        tx::Time::Timer timer;
+        bool solving = true;
+        for (int i = 0; i < steps && solving; ++i) solving = net.step(source, sink);
+        if (!solving) finish_impl();
+        report.analysisTime += timer.duration();
+        return done;
+    }
+
+private:
+    bool done = false;
+
+    void finish_impl() {
+        done = true;
+        report.throughput = net.flowSoFar();
+        // bottlenecks: saturated edges crossing the minimum cut
+        auto collect = [&](const EdgeList& edges, ThroughputReport::Limit limit) {
+            for (const auto& [handle, pos] : edges) {
+                const FlowNetwork::Edge& e = net.edge(handle);
+                if (net.onSourceSide(handle.first) && !net.onSourceSide(e.to) && e.original > 0.0f) {
+                    report.bottlenecks.push_back({ limit, pos, e.original });
+                }
+            }
+        };
+        collect(extractorEdges, ThroughputReport::Limit::Extraction);
+        collect(beltEdges,      ThroughputReport::Limit::Belt);
+        collect(inserterEdges,  ThroughputReport::Limit::Inserter);
+        collect(crafterEdges,   ThroughputReport::Limit::Crafter);
+    }
+};
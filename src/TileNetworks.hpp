@@ -0,0 +1,131 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+
+// Connected components of grid tiles that carry something between buildings (power, fluids).
+// Tiles are identified by their GridSystem index and connect to their 4 neighbours.
+// Placement joins networks incrementally (union by size, path halving); removal re-floods only
+// the members of the network that lost a tile. The root tile index identifies a network, so
+// owners keep per-network state in arrays indexed by tile and iterate roots() once per tick.
+class TileNetworks {
+public:
+    void reinit(int in_width, int in_height) {
+        width = in_width;
+        height = in_height;
+        parent.assign(width * height, -1);
+        sizes.assign(width * height, 0);
+        memberLists.assign(width * height, {});
+        rootSlot.assign(width * height, -1);
+        rootList.clear();
+    }
+
+    bool contains(int index) const { return parent[index] >= 0; }
+
+    int find(int index) {
+        while (parent[index] != index) {
+            parent[index] = parent[parent[index]];
+            index = parent[index];
+        }
+        return index;
+    }
+
+    // Adds a tile and joins it with its neighbours' networks.
+    // onMerge(into, from) is called for every union so owners can fold per-network state.
+    // Returns the root of the resulting network.
+    template<class MergeFunc>
+    int add(int index, MergeFunc&& onMerge) {
+        if (contains(index)) return find(index);
+        makeSingle_impl(index);
+        addRoot_impl(index);
+        int root = index;
+        forNeighbors_impl(index, [&](int neighbor) {
+            if (contains(neighbor)) root = unite_impl(root, find(neighbor), onMerge);
+        });
+        return root;
+    }
+
+    // Removes a tile; its old network is split into the components that are still connected.
+    // Returns the roots of those components (empty if the tile was alone); owners rebuild their
+    // state for exactly these networks from members().
+    const vector<int>& remove(int index) {
+        splitRoots.clear();
+        if (!contains(index)) return splitRoots;
+        int oldRoot = find(index);
+        vector<int> survivors;
+        survivors.swap(memberLists[oldRoot]);
+        eraseRoot_impl(oldRoot);
+        for (int member : survivors) parent[member] = -1; // detach while rebuilding
+
+        auto noMerge = [](int, int) {};
+        for (int member : survivors) {
+            if (member == index) continue;
+            makeSingle_impl(member);
+            addRoot_impl(member);
+        }
+        for (int member : survivors) {
+            if (member == index) continue;
+            forNeighbors_impl(member, [&](int neighbor) {
+                if (!contains(neighbor)) return;
+                int a = find(member), b = find(neighbor);
+                if (a != b) unite_impl(a, b, noMerge);
+            });
+        }
+        for (int member : survivors) {
+            if (member != index && find(member) == member) splitRoots.push_back(member);
+        }
+        return splitRoots;
+    }
+
+    const vector<int>& members(int root) const { return memberLists[root]; }
+    const vector<int>& roots() const { return rootList; }
+    int networkCount() const { return static_cast<int>(rootList.size()); }
+
+private:
+    int width = 0, height = 0;
+    vector<int> parent;              // -1 = tile is not part of any network
+    vector<int> sizes;               // valid for roots
+    vector<vector<int>> memberLists; // valid for roots
+    vector<int> rootSlot;            // position in rootList, -1 for non-roots
+    vector<int> rootList;
+    vector<int> splitRoots;
+
+    void makeSingle_impl(int index) {
+        parent[index] = index;
+        sizes[index] = 1;
+        memberLists[index].assign(1, index);
+    }
+
+    void addRoot_impl(int root) {
+        rootSlot[root] = static_cast<int>(rootList.size());
+        rootList.push_back(root);
+    }
+    void eraseRoot_impl(int root) {
+        int slot = rootSlot[root];
+        rootSlot[rootList.back()] = slot;
+        rootList[slot] = rootList.back();
+        rootList.pop_back();
+        rootSlot[root] = -1;
+    }
+
+    template<class MergeFunc>
+    int unite_impl(int a, int b, MergeFunc& onMerge) {
+        if (a == b) return a;
+        if (sizes[a] < sizes[b]) std::swap(a, b);
+        parent[b] = a;
+        sizes[a] += sizes[b];
+        vector<int>& into = memberLists[a];
+        into.insert(into.end(), memberLists[b].begin(), memberLists[b].end());
+        vector<int>().swap(memberLists[b]);
+        eraseRoot_impl(b);
+        onMerge(a, b);
+        return a;
+    }
+
+    template<class Func>
+    void forNeighbors_impl(int index, Func&& func) const {
+        int x = index % width, y = index / width;
+        if (x + 1 < width)  func(index + 1);
+        if (x > 0)          func(index - 1);
+        if (y + 1 < height) func(index + width);
+        if (y > 0)          func(index - width);
+    }
+};
@@ -0,0 +1,1819 @@
+#pragma once
+#include "TXLib/txlib.hpp"
+#include "TXLib/txgrid.hpp"
+#include "TXLib/txmath.hpp"
+#include "TXLib/txjson.hpp"
+#include "TXLib/txrandom.hpp"
+#include "Throughput.hpp"
+#include "Power.hpp"
+#include "Fluids.hpp"
+#include "Behavior.hpp"
+#include "Signals.hpp"
+#include "Drones.hpp"
+#include "TaskGraph.hpp"
+#include "Checksum.hpp"
+#include "BuildingStore.hpp"
+
+// The simulation: tiles, buildings, their networks and world generation.
+// Nothing here touches GLFW or OpenGL, so a World can be built and ticked without a window
+// (see headless.cpp); Game in Project.hpp renders one and turns input into placements.
+
+void initJsonObject(const std::filesystem::path& filePath, tx::JsonObject& root) {
+    cout << "init json...\n";
+    string str;
+    tx::readWholeFile(filePath, str);
+
+    root = tx::JsonObject{};
+    tx::JsonParser parser;
+    cout << "start init json.\n";
+    parser.parse(str, root);
+    cout << "init json done.\n";
+}
+
+enum class CoordDirection : uint16_t {
+    Right       = 0,        
+    Left        = 1,         
+    Top         = 2,          
+    Bottom      = 3,       
+    TopRight    = 4,     
+    TopLeft     = 5,      
+    BottomLeft  = 6,   
+    BottomRight = 7,
+    None        = 255  // No conveyor on this tile
+};
+constexpr tx::Coord dirToCoord(CoordDirection dir) {
+    return tx::_8wayIncrement[static_cast<int>(dir)];
+}
+
+struct Entity {
+    float distance = 0.0f;
+    float prevDistance = 0.0f;  // distance a tick earlier, negative while that was on the previous segment; for render interpolation
+    float size = 1.0f;
+    uint16_t id = 0;
+    uint16_t movedTick = 0;     // low bits of the tick prevDistance was taken in, an item can move on two segments per tick
+
+    void remember(uint16_t tick) {
+        if (movedTick == tick) return;
+        movedTick = tick;
+        prevDistance = distance;
+    }
+};
+
+class ConveyorSegment{
+    public:
+
+        // Returns true when the head item waits at the end to be handed over to a segment in
+        // another chunk; the world does that after every chunk has moved its belts
+        bool update(float dt, float speed, uint16_t tick) {
+            if (entities.empty()) return false;
+
+            Entity& head = entities.front();
+            head.remember(tick);
+            head.distance += speed * dt;
+
+            bool handoff = false;
+            if (head.distance >= length) {
+                if (nextsegment && !nextInOtherChunk && !nextsegment->isEntryBlocked()) {
+                    handOver();
+
+                    if (entities.empty()) return false;
+                } else {
+                    head.distance = length;
+                    handoff = nextsegment && nextInOtherChunk;
+                }
+            }
+
+            for (size_t i = 1; i < entities.size(); i++) {
+                Entity& current = entities[i];
+                Entity& ahead = entities[i-1];
+
+                current.remember(tick);
+                current.distance += speed * dt;
+                // Limit: current entity's front edge can't pass ahead entity's back edge
+                // Both entities take up 'size' space, so minimum gap is current.size + ahead.size
+                float limit = ahead.distance - ahead.size - current.size - ItemSpacing;
+
+                if (current.distance > limit) {
+                    current.distance = std::max(0.0f, limit);  // Clamp to non-negative
+                }
+            }
+            return handoff;
+        }
+
+        // Moves the head item onto the start of the next segment
+        void handOver() {
+            Entity transfer = entities.front();
+            transfer.prevDistance -= length;
+            transfer.distance = 0.0f;
+            nextsegment->push(transfer);
+            entities.pop_front();
+        }
+
+        // Puts an item on the entry end; an empty belt is back among the ones its chunk moves
+        void push(const Entity& entity) {
+            entities.push_back(entity);
+            ActiveList<ConveyorSegment>::wake(*this);
+        }
+
+        static constexpr float ItemSpacing = 0.4f;  // free gap kept between two items on a belt
+
+        // Items per second a saturated belt moves: consecutive items sit 2 * size + spacing apart
+        static constexpr float itemRate(float speed, float itemSize = 0.2f) {
+            return speed / (itemSize + itemSize + ItemSpacing);
+        }
+
+        float length = 1.0f;
+        ConveyorSegment* nextsegment = nullptr;
+        bool nextInOtherChunk = false;  // transfers to nextsegment are deferred to the end of the tick
+        ActiveList<ConveyorSegment>* activeList = nullptr;  // chunk's belts, active while it carries items
+        uint32_t activeSlot = 0;
+
+        std::deque<Entity> entities;
+        vector<tx::Coord> WayPoints;
+
+        tx::vec2 p1 = {0, 0}, p2 = {0, 0};
+		tx::vec2 center = { 0, 0 };
+		tx::Coord tilePos = {0, 0};  // Grid position of this segment
+		CoordDirection direction = CoordDirection::Right;  // Output direction of conveyor
+		CoordDirection inputDirection = CoordDirection::None;  // Input direction (where items come from)
+
+        // Check if the head entity is close enough to the end to be picked up by an inserter
+        bool hasItemInPickupWindow() const {
+            return !entities.empty() && entities.front().distance >= length * (1.0f - PickupWindow);
+        }
+        static constexpr float PickupWindow = 0.5f;  // last half of the segment
+
+        // Behaviors waiting for an item in the pickup window / for the entry to clear
+        WaitList itemWaiters;
+        WaitList spaceWaiters;
+        bool watched = false;  // registered in the behavior scheduler's watch list
+
+        // Check if a new entity of given size can enter (entry is at distance 0)
+        bool isEntryBlocked(float incomingSize = 0.2f) const {
+            if (entities.empty()) return false;
+            const Entity& last = entities.back();  // Entity closest to entry point
+            // The incoming entity at distance=0 with size would collide if:
+            // last.distance - last.size - incomingSize < 0
+            return last.distance < last.size + incomingSize;
+        }
+};
+
+enum class TileType{
+    Space,
+    Ore_Iron,
+    Ore_Copper,
+    Ore_Coal,
+    Ore_Gold
+};
+
+// Extractor: placed on ore tiles, outputs items to adjacent conveyors
+class Extractor {
+public:
+    static constexpr uint8_t AllSides = 0b1111;
+
+    tx::Coord pos = {0, 0};
+    CoordDirection outputDir = CoordDirection::Right;  // first side in the round-robin
+    uint8_t outputSides = AllSides;                   // bit per CoordDirection (Right, Left, Top, Bottom)
+    TileType oreType = TileType::Space;
+    
+    float extractInterval = 1.0f;  // seconds between extractions
+    uint64_t mineEndTick = 0;      // tick the item being mined comes out (the behavior sleeps until then)
+    int* deposit = nullptr;        // remaining ore of the tile (entry in World::oreAmounts), null = infinite
+
+    // Output belts, resolved by World at placement time and when an adjacent belt is built
+    std::array<ConveyorSegment*, 4> ports{};
+    int portCount = 0;
+    int nextPort = 0;       // round-robin cursor
+    bool holding = false;   // mined item waiting for a free port
+
+    Behavior behavior;      // World::runExtractor_impl
+    WaitList linkWaiters;   // parked here while there is nothing to do until ports change
+
+    bool depleted() const { return deposit && *deposit <= 0; }
+
+    void setPorts(const std::array<ConveyorSegment*, 4>& in_ports, int in_count) {
+        ports = in_ports;
+        portCount = in_count;
+        nextPort = 0;
+    }
+
+    // Hands the held item to the next free port in round-robin order
+    bool tryOutput() {
+        for (int tried = 0; tried < portCount; ++tried) {
+            ConveyorSegment* outputBelt = ports[nextPort];
+            nextPort = (nextPort + 1) % portCount;
+            if (outputBelt->isEntryBlocked(0.2f)) continue;
+
+            Entity newEntity;
+            newEntity.distance = 0.0f;
+            newEntity.size = 0.2f;
+            newEntity.id = itemId();
+            outputBelt->push(newEntity);
+            holding = false;
+            return true;
+        }
+        return false;
+    }
+
+    // ID based on ore type for sprite selection
+    uint16_t itemId() const {
+        switch (oreType) {
+            case TileType::Ore_Coal:   return 0;
+            case TileType::Ore_Copper: return 1;
+            case TileType::Ore_Gold:   return 2;
+            case TileType::Ore_Iron:   return 3;
+            default: return 0;
+        }
+    }
+};
+
+// Storage: buffers items for inserters; wakes them when items arrive or space frees up
+class Storage {
+public:
+    static constexpr int ItemTypes = 8;  // Entity::id range: ores 0-3, ingots 4-7
+
+    tx::Coord pos = {0, 0};
+    int capacity = 50;
+    std::array<int, ItemTypes> counts{};
+    int total = 0;
+
+    WaitList itemWaiters;   // behaviors waiting to take an item
+    WaitList spaceWaiters;  // behaviors waiting to drop an item
+    // total is written to signal once something reads it (World::storageSignal)
+    SignalNetwork* signals = nullptr;
+    SignalNetwork::Node signal = SignalNetwork::None;
+
+    bool hasItem()  const { return total > 0; }
+    bool hasSpace() const { return total < capacity; }
+
+    void put(uint16_t itemId, vector<BehaviorHandle>& ready) {
+        ++counts[itemId % ItemTypes];
+        ++total;
+        if (signals) signals->set(signal, total);
+        itemWaiters.wakeInto(ready);
+    }
+    // takes from the most stocked item type
+    uint16_t take(vector<BehaviorHandle>& ready) {
+        int type = static_cast<int>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+        --counts[type];
+        --total;
+        if (signals) signals->set(signal, total);
+        spaceWaiters.wakeInto(ready);
+        return static_cast<uint16_t>(type);
+    }
+};
+
+// Crafter: smelts ore (ids 0-3) into ingots (ids 4-7), runs at the speed its power network allows.
+// Refineries are crafters that also draw fluid from their pipe run and yield two ingots per ore.
+class Crafter {
+public:
+    static constexpr int OreTypes = 4;
+    static constexpr int InputCapacity = 10;
+    static constexpr int OutputCapacity = 10;
+
+    enum class Kind : uint8_t { Smelter, Refinery };
+
+    tx::Coord pos = {0, 0};
+    uint32_t storeId = 0;       // id in World::crafters
+    Kind kind = Kind::Smelter;
+    float craftTime = 1.0f;     // seconds per ore at full power
+    float powerDemand = 90.0f;  // kW drawn while working
+    float fluidPerItem = 0.0f;  // fluid units used per ore, 0 = no fluid input
+    int yield = 1;              // ingots per ore
+    float fluid = 0.0f;         // fluid drawn from the pipe run, waiting to be used
+
+    std::array<int, OreTypes> inputs{};
+    std::array<int, OreTypes> outputs{};
+    int inputTotal = 0;
+    int outputTotal = 0;
+    int recipe = -1;        // ore being smelted, -1 = idle
+    float progress = 0.0f;  // seconds of full-power work done on the current ingot
+
+    WaitList itemWaiters;   // inserters waiting for an ingot
+    WaitList spaceWaiters;  // inserters waiting to drop ore
+    ActiveList<Crafter>* activeList = nullptr;  // chunk's crafters, active while it has ore or works
+    uint32_t activeSlot = 0;
+    int phase = 0;           // updated at ticks where (tick + phase) % World::crafterInterval == 0
+    uint64_t until = 0;      // first tick not simulated yet
+
+    void makeRefinery() {
+        kind = Kind::Refinery;
+        craftTime = 2.0f;
+        powerDemand = 150.0f;
+        fluidPerItem = 10.0f;
+        yield = 2;
+    }
+
+    bool working() const { return recipe >= 0; }
+    bool idle() const { return !working() && inputTotal == 0; }
+    bool needsFluid() const { return fluid < fluidPerItem; }
+    // only ore can be smelted; inserters holding anything else wait on the crafter
+    bool accepts(uint16_t itemId) const { return itemId < OreTypes; }
+    bool hasItem()  const { return outputTotal > 0; }
+    bool hasSpace() const { return inputTotal < InputCapacity; }
+
+    // Unlike a storage, neither wakes inserters: space and ingots only appear in update()
+    void put(uint16_t itemId) {
+        ++inputs[itemId];
+        ++inputTotal;
+        ActiveList<Crafter>::wake(*this);
+    }
+    uint16_t take() {
+        int type = static_cast<int>(std::max_element(outputs.begin(), outputs.end()) - outputs.begin());
+        --outputs[type];
+        --outputTotal;
+        return static_cast<uint16_t>(type + OreTypes);
+    }
+
+    // speed: power satisfaction of the crafter's network (0..1).
+    // A recipe started from idle makes progress from the next update on, after its demand was counted.
+    // Work done past the end of a recipe goes to the next one if it can start right away, so an
+    // update covering several ticks finishes as many ingots as those ticks one by one would.
+    // Inserters waiting on the crafter are collected in woken rather than queued, chunks update in parallel.
+    void update(float dt, float speed, vector<BehaviorHandle>& woken) {
+        if (!working()) {
+            start_impl(woken);
+            return;
+        }
+        progress += dt * speed;
+        while (working() && progress >= craftTime) {
+            float carry = progress - craftTime;
+            outputs[recipe] += yield;
+            outputTotal += yield;
+            recipe = -1;
+            progress = 0.0f;
+            itemWaiters.takeInto(woken);
+            if (start_impl(woken)) progress = carry;
+        }
+    }
+
+private:
+    bool start_impl(vector<BehaviorHandle>& woken) {
+        if (inputTotal == 0 || outputTotal + yield > OutputCapacity || needsFluid()) return false;
+        recipe = static_cast<int>(std::find_if(inputs.begin(), inputs.end(), [](int n) { return n > 0; }) - inputs.begin());
+        --inputs[recipe];
+        --inputTotal;
+        fluid -= fluidPerItem;
+        spaceWaiters.takeInto(woken);
+        return true;
+    }
+};
+
+// Generator: constant power source
+struct Generator {
+    tx::Coord pos = {0, 0};
+    uint32_t storeId = 0;  // id in World::generators
+    float output = 180.0f;  // kW
+};
+
+// Power pole: only connects neighbouring power buildings
+struct PowerPole {
+    tx::Coord pos = {0, 0};
+    uint32_t storeId = 0;  // id in World::poles
+};
+
+// Pipe: joins neighbouring fluid buildings into one run
+struct Pipe {
+    tx::Coord pos = {0, 0};
+    uint32_t storeId = 0;  // id in World::pipes
+};
+
+// Pump: constant fluid source feeding its run
+struct Pump {
+    tx::Coord pos = {0, 0};
+    uint32_t storeId = 0;  // id in World::pumps
+    float rate = 20.0f;  // units per second
+};
+
+// Where an inserter picks up from or drops to: a conveyor segment, a storage or a crafter
+struct ItemEndpoint {
+    ConveyorSegment* belt = nullptr;
+    Storage* storage = nullptr;
+    Crafter* crafter = nullptr;
+
+    bool valid() const { return belt || storage || crafter; }
+    bool hasItem() const {
+        if (belt)    return belt->hasItemInPickupWindow();
+        if (storage) return storage->hasItem();
+        return crafter && crafter->hasItem();
+    }
+    bool hasSpace(uint16_t itemId) const {
+        if (belt)    return !belt->isEntryBlocked(0.2f);
+        if (storage) return storage->hasSpace();
+        return crafter && crafter->accepts(itemId) && crafter->hasSpace();
+    }
+    uint16_t take(vector<BehaviorHandle>& ready) {
+        if (storage) return storage->take(ready);
+        if (crafter) return crafter->take();
+        uint16_t itemId = belt->entities.front().id;
+        belt->entities.pop_front();
+        return itemId;
+    }
+    void put(uint16_t itemId, vector<BehaviorHandle>& ready) {
+        if (storage) { storage->put(itemId, ready); return; }
+        if (crafter) { crafter->put(itemId); return; }
+        Entity newEntity;
+        newEntity.distance = 0.0f;
+        newEntity.size = 0.2f;
+        newEntity.id = itemId;
+        belt->push(newEntity);
+    }
+    WaitList& itemWaiters() {
+        if (belt)    return belt->itemWaiters;
+        if (storage) return storage->itemWaiters;
+        return crafter->itemWaiters;
+    }
+    WaitList& spaceWaiters() {
+        if (belt)    return belt->spaceWaiters;
+        if (storage) return storage->spaceWaiters;
+        return crafter->spaceWaiters;
+    }
+};
+
+class BehaviorScheduler;
+// Inserter: moves one item at a time from the tile behind it to the tile in front of it.
+// Its behavior never polls: while waiting it is parked on its source or target and only runs
+// again when that building reports an item in the pickup window or free capacity.
+class Inserter {
+public:
+    enum class State : uint8_t {
+        Dormant,     // source or target missing, woken by relinking
+        WaitSource,  // parked on source.itemWaiters
+        WaitTarget,  // parked on target.spaceWaiters, holding an item
+        Swing,       // moving an item, on the swing timer
+        Disabled     // parked on its enable signal while that is 0
+    };
+
+    tx::Coord pos = {0, 0};
+    CoordDirection dir = CoordDirection::Right;  // drop side; picks up from the opposite side
+    float swingTime = 0.5f;  // seconds from pickup to drop
+
+    ItemEndpoint source, target;
+    State state = State::Dormant;
+    bool holding = false;
+    uint16_t heldItem = 0;
+    uint64_t swingEndTick = 0;
+
+    Behavior behavior;
+    WaitList linkWaiters;  // parked here while dormant
+    // picks nothing up while the signal is 0 (World::setInserterCondition); None = always on
+    SignalNetwork* signals = nullptr;
+    SignalNetwork::Node enableSignal = SignalNetwork::None;
+
+    tx::Coord pickupPos() const { return pos - dirToCoord(dir); }
+    tx::Coord dropPos()   const { return pos + dirToCoord(dir); }
+    bool enabled() const { return enableSignal == SignalNetwork::None || signals->value(enableSignal) != 0; }
+
+    Behavior run(BehaviorScheduler& scheduler);
+};
+
+// Resumes behaviors whose condition is met: expired timers, buildings that woke their waiters,
+// and watched belts (checked once per tick, only while someone sleeps on them)
+class BehaviorScheduler {
+public:
+    uint64_t tick = 0;
+    float tickTime = 0.016f;
+    vector<BehaviorHandle> ready;
+
+    void start(Behavior& behavior) { queue_impl(behavior.handle()); }
+
+    // Makes a parked behavior re-check its condition (used when its links change).
+    // Behaviors on a timer are left alone, they re-check when it fires.
+    void interrupt(Behavior& behavior) {
+        BehaviorHandle handle = behavior.handle();
+        if (!handle || !handle.promise().parkedCount) return;
+        unparkBehavior(handle);
+        queue_impl(handle);
+    }
+
+    uint64_t ticksFor(float seconds) const {
+        return std::max<uint64_t>(static_cast<uint64_t>(std::ceil(seconds / tickTime)), 1);
+    }
+
+    // co_await scheduler.sleep(n): resume n ticks later
+    auto sleep(uint64_t ticks) {
+        struct Awaiter {
+            BehaviorScheduler& scheduler;
+            uint64_t ticks;
+            bool await_ready() const { return ticks == 0; }
+            void await_suspend(BehaviorHandle handle) { scheduler.timers.push({ scheduler.tick + ticks, handle }); }
+            void await_resume() const {}
+        };
+        return Awaiter{ *this, ticks };
+    }
+    // co_await scheduler.until(list): park until the list is woken or the behavior is interrupted
+    auto until(WaitList& list) {
+        struct Awaiter {
+            WaitList& list;
+            bool await_ready() const { return false; }
+            void await_suspend(BehaviorHandle handle) { list.park(handle); }
+            void await_resume() const {}
+        };
+        return Awaiter{ list };
+    }
+    // co_await scheduler.item(endpoint): an item can be taken
+    auto item(ItemEndpoint& endpoint) {
+        struct Awaiter {
+            BehaviorScheduler& scheduler;
+            ItemEndpoint& endpoint;
+            bool await_ready() const { return endpoint.hasItem(); }
+            void await_suspend(BehaviorHandle handle) {
+                endpoint.itemWaiters().park(handle);
+                if (endpoint.belt) scheduler.watch_impl(endpoint.belt);
+            }
+            void await_resume() const {}
+        };
+        return Awaiter{ *this, endpoint };
+    }
+    // co_await scheduler.space(endpoint, itemId): the item can be dropped
+    auto space(ItemEndpoint& endpoint, uint16_t itemId) {
+        struct Awaiter {
+            BehaviorScheduler& scheduler;
+            ItemEndpoint& endpoint;
+            uint16_t itemId;
+            bool await_ready() const { return endpoint.hasSpace(itemId); }
+            void await_suspend(BehaviorHandle handle) {
+                endpoint.spaceWaiters().park(handle);
+                if (endpoint.belt) scheduler.watch_impl(endpoint.belt);
+            }
+            void await_resume() const {}
+        };
+        return Awaiter{ *this, endpoint, itemId };
+    }
+    // co_await scheduler.anySpace(belts, count): the entry of at least one belt is free
+    auto anySpace(ConveyorSegment* const* belts, int count) {
+        struct Awaiter {
+            BehaviorScheduler& scheduler;
+            ConveyorSegment* const* belts;
+            int count;
+            bool await_ready() const {
+                for (int i = 0; i < count; ++i) if (!belts[i]->isEntryBlocked(0.2f)) return true;
+                return false;
+            }
+            void await_suspend(BehaviorHandle handle) {
+                for (int i = 0; i < count; ++i) {
+                    belts[i]->spaceWaiters.park(handle);
+                    scheduler.watch_impl(belts[i]);
+                }
+            }
+            void await_resume() const {}
+        };
+        return Awaiter{ *this, belts, count };
+    }
+
+    // called once per tick after belts moved
+    void update() {
+        ++tick;
+        // belts report their state once per tick, regardless of how many behaviors sleep on them
+        size_t kept = 0;
+        for (ConveyorSegment* seg : watchedSegments) {
+            if (!seg->itemWaiters.empty()  && seg->hasItemInPickupWindow()) seg->itemWaiters.wakeInto(ready);
+            if (!seg->spaceWaiters.empty() && !seg->isEntryBlocked(0.2f))   seg->spaceWaiters.wakeInto(ready);
+            if (seg->itemWaiters.empty() && seg->spaceWaiters.empty()) seg->watched = false;
+            else watchedSegments[kept++] = seg;
+        }
+        watchedSegments.resize(kept);
+
+        while (!timers.empty() && timers.top().first <= tick) {
+            queue_impl(timers.top().second);
+            timers.pop();
+        }
+
+        while (!ready.empty()) {
+            vector<BehaviorHandle> batch;
+            batch.swap(ready);
+            for (BehaviorHandle handle : batch) {
+                handle.promise().queued = false;
+                unparkBehavior(handle); // it may still sit on other lists it waited on
+                if (!handle.done()) handle.resume();
+            }
+        }
+    }
+
+private:
+    using Timer = std::pair<uint64_t, BehaviorHandle>;
+    struct TimerCmp { bool operator()(const Timer& a, const Timer& b) const { return a.first > b.first; } };
+    std::priority_queue<Timer, vector<Timer>, TimerCmp> timers;
+    vector<ConveyorSegment*> watchedSegments;
+
+    void queue_impl(BehaviorHandle handle) {
+        if (handle.promise().queued) return;
+        handle.promise().queued = true;
+        ready.push_back(handle);
+    }
+    void watch_impl(ConveyorSegment* belt) {
+        if (belt->watched) return;
+        belt->watched = true;
+        watchedSegments.push_back(belt);
+    }
+};
+
+inline Behavior Inserter::run(BehaviorScheduler& scheduler) {
+    for (;;) {
+        if (holding) {
+            state = State::WaitTarget;
+            if (!target.valid()) { co_await scheduler.until(linkWaiters); continue; } // hold the item until a target is built
+            if (!target.hasSpace(heldItem)) { co_await scheduler.space(target, heldItem); continue; }
+            target.put(heldItem, scheduler.ready);
+            holding = false;
+        }
+        if (!enabled()) {
+            state = State::Disabled;
+            co_await scheduler.until(signals->watchers(enableSignal));
+            continue;
+        }
+        if (!source.valid() || !target.valid()) {
+            state = State::Dormant;
+            co_await scheduler.until(linkWaiters);
+            continue;
+        }
+        if (!source.hasItem()) {
+            state = State::WaitSource;
+            co_await scheduler.item(source);
+            continue;
+        }
+        heldItem = source.take(scheduler.ready);
+        holding = true;
+        state = State::Swing;
+        swingEndTick = scheduler.tick + scheduler.ticksFor(swingTime);
+        co_await scheduler.sleep(scheduler.ticksFor(swingTime));
+    }
+}
+
+class Tile {
+public:
+
+    void update() {
+        switch(m_type){
+
+        }
+    }
+
+    void setType(TileType in) { m_type = in; }
+    // void setExtracter() {}
+    void setPos(const tx::Coord& in) { m_pos = in; }
+    TileType        type() const { return m_type; }
+    const tx::Coord& pos() const {return m_pos;}
+    bool operator==(const Tile& other) const { return this->m_type == other.m_type; }
+    bool operator!=(const Tile& other) const { return this->m_type != other.m_type; }
+
+    void setConveyor(ConveyorSegment* ptr) {conveyer = ptr; }
+    ConveyorSegment* getConveyor() const {return conveyer; }
+    void setStorage(Storage* ptr) { storage = ptr; }
+    Storage* getStorage() const { return storage; }
+    void setInserter(Inserter* ptr) { inserter = ptr; }
+    Inserter* getInserter() const { return inserter; }
+    void setExtractor(Extractor* ptr) { extractor = ptr; }
+    Extractor* getExtractor() const { return extractor; }
+    void setCrafter(Crafter* ptr) { crafter = ptr; }
+    Crafter* getCrafter() const { return crafter; }
+    void setGenerator(Generator* ptr) { generator = ptr; }
+    Generator* getGenerator() const { return generator; }
+    void setPole(PowerPole* ptr) { pole = ptr; }
+    PowerPole* getPole() const { return pole; }
+    void setPipe(Pipe* ptr) { pipe = ptr; }
+    Pipe* getPipe() const { return pipe; }
+    void setPump(Pump* ptr) { pump = ptr; }
+    Pump* getPump() const { return pump; }
+
+private:
+    TileType m_type = TileType::Space;
+    tx::Coord m_pos;
+    ConveyorSegment* conveyer = nullptr;
+    Storage* storage = nullptr;
+    Inserter* inserter = nullptr;
+    Extractor* extractor = nullptr;
+    Crafter* crafter = nullptr;
+    Generator* generator = nullptr;
+    PowerPole* pole = nullptr;
+    Pipe* pipe = nullptr;
+    Pump* pump = nullptr;
+};
+
+
+// tile amount: 64
+class World {
+public:
+    using TileIndex = uint32_t;  // tiles.index(); 16 bits would wrap on maps past 256x256
+    static constexpr float ConveyorSpeed = 2.0f;  // segment lengths per second
+
+    struct BuildStep {
+        tx::Coord pos;
+        CoordDirection dir;
+    };
+
+    static constexpr uint32_t RandomSeed = 0;  // config Simulation.seed, or a fresh one if that is missing or 0
+
+    // Sampled every statisticsInterval ticks (config Simulation.statisticsRate, samples per second)
+    struct Statistics {
+        uint64_t tick = 0;
+        int storedItems = 0;  // in storages
+        int beltItems = 0;    // on belts
+        int workingCrafters = 0;
+    };
+    static constexpr int StatisticsHistory = 60;  // samples kept
+
+    // Random streams split off the world seed, one per user, so none of them shares a generator
+    enum class RandomStream : uint64_t {
+        OreClusters,  // then per ore type and cluster
+        OreAmounts,   // then per ore tile
+        Render        // asset variants, per tile
+    };
+
+    // Worlds built from the same config and seed generate the same map and, given the same
+    // placements, tick through the same states whatever their thread count
+    World(const tx::JsonObject& cfg, int in_mapSize = 16, int threadAmount = tx::JobSystem::defaultThreadAmount(),
+          uint32_t in_seed = RandomSeed) :
+        jobSystem(threadAmount),
+        MapSize(in_mapSize),
+        seed(in_seed)
+    {
+        if (cfg.exist("Simulation")) {
+            const tx::JsonObject& simulation = cfg["Simulation"].get<tx::JsonObject>();
+            TickTime = 1.0f / simulation["tickRate"].get<int>();
+            if (seed == RandomSeed) seed = static_cast<uint32_t>(simulation.getOr<int>("seed", 0));
+            int checksumLog = simulation.getOr<int>("checksumLog", 0);
+            if (checksumLog > 0) enableChecksum(checksumLog, true);
+            crafterInterval = intervalFor_impl(simulation.getOr<int>("crafterRate", 15));
+            statisticsInterval = intervalFor_impl(simulation.getOr<int>("statisticsRate", 1));
+        }
+        if (seed == RandomSeed) seed = std::random_device{}();
+        random = tx::Random{ seed };
+        tiles.reinit(MapSize);
+        tiles.foreach([](Tile& in, const tx::Coord& pos) { in.setPos(pos); });
+        
+        // Initialize conveyor direction grid with None (no conveyor)
+        conveyorDirections.reinit(MapSize);
+        conveyorDirections.foreach([](CoordDirection& dir, const tx::Coord&) { dir = CoordDirection::None; });
+        scheduler.tickTime = TickTime;
+        power.reinit(MapSize, MapSize);
+        fluids.reinit(MapSize, MapSize);
+        flowFields.reinit(MapSize, MapSize, threadAmount / 2);
+        drones.reinit(MapSize, MapSize);
+        chunksX = (MapSize + ChunkSize - 1) / ChunkSize;
+        chunks.resize(chunksX * chunksX);
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            chunks[c].phase = static_cast<int>(c % CoarseInterval);
+        }
+
+        genOreTiles_impl(cfg);
+        buildTickGraph_impl();
+    }
+
+    // One tick: the phases of tickGraph due this tick, independent ones in parallel
+    void update() {
+        tickGraph.run(jobSystem, scheduler.tick);
+    }
+    
+    // Drones shuttle between the two storages of their route, one item per trip
+    void updateDroneFlight(float dt) {
+        flowFields.update();
+        drones.update(dt, flowFields);
+    }
+    void updateDroneArrivals() {
+        for (Drone& drone : drones.data()) {
+            if (!drones.arrived(drone)) continue;
+            DroneRoute& route = droneRoutes[drone.mission];
+            if (!drone.carrying && route.from->hasItem()) {
+                drone.item = route.from->take(scheduler.ready);
+                drone.carrying = true;
+                drone.destination = tiles.index(route.to->pos);
+            } else if (drone.carrying && route.to->hasSpace()) {
+                route.to->put(drone.item, scheduler.ready);
+                drone.carrying = false;
+                drone.destination = tiles.index(route.from->pos);
+            }
+        }
+    }
+
+    // Spawns drones at one storage that keep carrying its items to another
+    bool addDroneRoute(const tx::Coord& from, const tx::Coord& to, int count) {
+        if (!valid_impl(from) || !valid_impl(to) || from == to) return false;
+        Storage* source = tiles.at(from).getStorage();
+        Storage* target = tiles.at(to).getStorage();
+        if (!source || !target) return false;
+
+        droneRoutes.push_back({ source, target });
+        uint32_t mission = static_cast<uint32_t>(droneRoutes.size() - 1);
+        for (int i = 0; i < count; ++i) {
+            Drone& drone = drones.spawn(tx::vec2{ from.x() + 0.5f, from.y() + 0.5f }, tiles.index(from));
+            drone.mission = mission;
+        }
+        return true;
+    }
+
+    // Crafters run at their network's satisfaction and report demand only when it changes;
+    // refineries top up their fluid from the pipe run before starting the next ore.
+    // Networks span chunks, so they are read before and written after the parallel part.
+    // A crafter in view is updated every crafterInterval ticks, its phase spreading the crafters
+    // of a chunk evenly over the ticks in between; out of view all of them go with the chunk.
+    void updateCrafters(float dt) {
+        uint64_t tick = scheduler.tick;
+        int work = 0;
+        for (BuildingChunk& chunk : chunks) {
+            chunk.crafterTicks = chunk.due(tick, chunk.craftersUntil);
+            if (chunk.crafterTicks == 0) continue;
+            chunk.steps.resize(chunk.crafters.active());
+            for (size_t i = 0; i < chunk.crafters.active(); ++i) {
+                Crafter& crafter = *chunk.crafters[i];
+                chunk.steps[i] = { 0, 0.0f };
+                if (chunk.detailed && (tick + crafter.phase) % crafterInterval != 0) continue;
+                int index = tiles.index(crafter.pos);
+                if (crafter.needsFluid()) {
+                    crafter.fluid += fluids.draw(index, crafter.fluidPerItem - crafter.fluid);
+                }
+                chunk.steps[i] = { static_cast<int>(tick + 1 - crafter.until), power.satisfaction(index) };
+                crafter.until = tick + 1;
+                ++work;
+            }
+        }
+        forEachChunk_impl(work, [dt](BuildingChunk& chunk) {
+            if (chunk.crafterTicks == 0) return;
+            for (size_t i = 0; i < chunk.crafters.active(); ++i) {
+                auto [ticks, speed] = chunk.steps[i];
+                if (ticks == 0) continue;
+                Crafter& crafter = *chunk.crafters[i];
+                bool wasWorking = crafter.working();
+                crafter.update(dt * ticks, speed, chunk.woken);
+                if (crafter.working() != wasWorking) {
+                    chunk.demandChanges.push_back({ &crafter, crafter.working() ? crafter.powerDemand : 0.0f });
+                }
+            }
+            // out of ore and done: skipped until an inserter drops ore (Crafter::put)
+            for (size_t i = 0; i < chunk.crafters.active();) {
+                Crafter* crafter = chunk.crafters[i];
+                if (crafter->idle()) chunk.crafters.deactivate(crafter);
+                else ++i;
+            }
+        });
+        for (BuildingChunk& chunk : chunks) {
+            for (const auto& [crafter, demand] : chunk.demandChanges) {
+                power.setDemand(tiles.index(crafter->pos), demand);
+            }
+            chunk.demandChanges.clear();
+            queueWoken_impl(chunk.woken);
+        }
+    }
+
+    // Restrict which sides an extractor outputs to (bit per CoordDirection)
+    void setExtractorOutputSides(const tx::Coord& pos, uint8_t sides) {
+        if (!valid_impl(pos)) return;
+        Extractor* extractor = tiles.at(pos).getExtractor();
+        if (!extractor) return;
+        extractor->outputSides = sides & Extractor::AllSides;
+        computeExtractorPorts_impl(*extractor);
+    }
+
+    // Steady-state throughput of the current layout without ticking the simulation.
+    // Graph: source -> extractors (mining rate) -> output ports -> conveyor chains (belt rate per
+    // segment) -> inserters (one item per swing) -> crafters (ore per second) / storages -> sink.
+    // Items only leave a line through an inserter; storages are drained by the sink, as they are
+    // while they fill up. Crafters count ore, so a refinery's second ingot is not in the total.
+    ThroughputReport analyzeThroughput() {
+        ThroughputAnalysis analysis = buildThroughputAnalysis();
+        while (!analysis.step()) {}
+        return analysis.report;
+    }
+    // The production graph of the current layout, to be solved with ThroughputAnalysis::step()
+    ThroughputAnalysis buildThroughputAnalysis() {
+        tx::Time::Timer timer;
+        ThroughputAnalysis analysis;
+        FlowNetwork& net = analysis.net;
+        ThroughputReport& report = analysis.report;
+        int source = analysis.source = net.addNode();
+        int sink   = analysis.sink   = net.addNode();
+
+        // every segment is split into in -> out so its belt rate becomes an edge capacity
+        std::unordered_map<const ConveyorSegment*, int> segmentIn;
+        segmentIn.reserve(conveyorBelts.size());
+        const float beltRate = ConveyorSegment::itemRate(ConveyorSpeed);
+        analysis.beltEdges.reserve(conveyorBelts.size());
+        for (const ConveyorSegment& seg : conveyorBelts) {
+            int in  = net.addNode();
+            int out = net.addNode();
+            segmentIn[&seg] = in;
+            analysis.beltEdges.push_back({ net.addEdge(in, out, beltRate), seg.tilePos });
+        }
+        for (const ConveyorSegment& seg : conveyorBelts) {
+            if (seg.nextsegment) net.addEdge(segmentIn[&seg] + 1, segmentIn[seg.nextsegment], FlowNetwork::Infinite);
+        }
+
+        std::unordered_map<const Storage*, int> storageNode;
+        storageNode.reserve(storages.size());
+        for (const Storage& storage : storages) {
+            int node = storageNode[&storage] = net.addNode();
+            net.addEdge(node, sink, FlowNetwork::Infinite);
+        }
+        // in -> out like belts: ore in, ingots out
+        std::unordered_map<const Crafter*, int> crafterIn;
+        crafterIn.reserve(crafters.size());
+        analysis.crafterEdges.reserve(crafters.size());
+        for (const Crafter& crafter : crafters) {
+            int in  = crafterIn[&crafter] = net.addNode();
+            int out = net.addNode();
+            analysis.crafterEdges.push_back({ net.addEdge(in, out, 1.0f / crafter.craftTime), crafter.pos });
+        }
+        // an inserter takes from the end of a belt, a storage or a crafter's output and drops onto
+        // the start of a belt, into a storage or a crafter's input
+        auto takeNode = [&](const ItemEndpoint& endpoint) {
+            if (endpoint.belt)    return segmentIn[endpoint.belt] + 1;
+            if (endpoint.storage) return storageNode[endpoint.storage];
+            return crafterIn[endpoint.crafter] + 1;
+        };
+        auto putNode = [&](const ItemEndpoint& endpoint) {
+            if (endpoint.belt)    return segmentIn[endpoint.belt];
+            if (endpoint.storage) return storageNode[endpoint.storage];
+            return crafterIn[endpoint.crafter];
+        };
+        analysis.inserterEdges.reserve(inserters.size());
+        for (const Inserter& inserter : inserters) {
+            if (!inserter.source.valid() || !inserter.target.valid()) continue;
+            int in  = net.addNode();
+            int out = net.addNode();
+            float rate = 1.0f / (scheduler.ticksFor(inserter.swingTime) * TickTime);
+            analysis.inserterEdges.push_back({ net.addEdge(in, out, rate), inserter.pos });
+            net.addEdge(takeNode(inserter.source), in, FlowNetwork::Infinite);
+            net.addEdge(out, putNode(inserter.target), FlowNetwork::Infinite);
+        }
+
+        analysis.extractorEdges.reserve(extractors.size());
+        for (const Extractor& extractor : extractors) {
+            if (extractor.depleted()) continue;
+            float rate = 1.0f / extractor.extractInterval;
+            report.extractionRate += rate;
+            if (!extractor.portCount) continue; // output goes nowhere
+            int node = net.addNode();
+            analysis.extractorEdges.push_back({ net.addEdge(source, node, rate), extractor.pos });
+            for (int i = 0; i < extractor.portCount; ++i) {
+                net.addEdge(node, segmentIn[extractor.ports[i]], FlowNetwork::Infinite);
+            }
+        }
+
+        report.extractorCount = static_cast<int>(extractors.size());
+        report.segmentCount = static_cast<int>(conveyorBelts.size());
+        report.inserterCount = static_cast<int>(inserters.size());
+        report.crafterCount = static_cast<int>(crafters.size());
+        report.storageCount = static_cast<int>(storages.size());
+        report.analysisTime = timer.duration();
+        return analysis;
+    }
+
+    void initTestConveyors() {
+        placeConveyor({2, 2}, CoordDirection::Right);
+        placeConveyor({3, 2}, CoordDirection::Right);
+
+        if (tiles.at({2, 2}).getConveyor()) {
+            Entity item;
+            item.distance = 0.0f;
+            item.size = 0.2f;
+            item.id = 1;
+            tiles.at({2,2}).getConveyor()->push(item);
+        }
+    }
+
+    // false if pos is off the map or already has a building (a belt included)
+    bool placeConveyor(tx::Coord pos, CoordDirection dir) {
+        if (!valid_impl(pos) || isOccupied(pos)) return false;
+
+        // Register direction
+        conveyorDirections.at(pos) = dir;
+
+        ConveyorSegment* newSeg = &conveyorBelts[conveyorBelts.create()];
+        newSeg->length = 1.0f;
+        newSeg->tilePos = pos;  // Store tile position
+        newSeg->direction = dir;  // Store direction for sprite selection
+
+        // Calculate Geometry (tile units: tile (x, y) covers [x, x + 1) x [y, y + 1))
+        float halfSize = 0.5f;
+        tx::vec2 center = tx::toVec2(pos) + tx::vec2{ halfSize, halfSize };
+        newSeg->center = center; // Store center
+
+        tx::Coord delta = dirToCoord(dir);
+        tx::vec2 dirVec = { (float)delta.x(), (float)delta.y() };
+
+        // Default: Straight line (Center-Dir -> Center+Dir)
+        newSeg->p1 = center - (dirVec * halfSize);
+        newSeg->p2 = center + (dirVec * halfSize);
+
+        tiles.at(pos).setConveyor(newSeg);
+        chunks[chunkOf_impl(pos)].belts.add(newSeg);
+
+        // --- 1. BACKWARD SNAP (Inputs) ---
+        // Look for neighbors that point AT us. Snap our start to their end.
+        for(int i = 0; i < 4; ++i) { // Check NESW
+            tx::Coord checkPos = pos + dirToCoord(static_cast<CoordDirection>(i));
+            if (!valid_impl(checkPos)) continue;
+            
+            // Is there a conveyor?
+            if (conveyorDirections.at(checkPos) == CoordDirection::None) continue;
+            
+            ConveyorSegment* prev = tiles.at(checkPos).getConveyor();
+            if (!prev) continue;
+
+            // Does it point to us?
+            CoordDirection prevDir = conveyorDirections.at(checkPos);
+            tx::Coord outputOffset = dirToCoord(prevDir);
+            
+            if (checkPos + outputOffset == pos) {
+                // YES! It feeds us.
+                // 1. Snap our Start (p1) to their End (p2)
+                newSeg->p1 = prev->p2;
+                
+                // 2. Link them to us
+                prev->nextsegment = newSeg;
+                prev->nextInOtherChunk = chunkOf_impl(checkPos) != chunkOf_impl(pos);
+                
+                // 3. Record our input direction (opposite of where the prev segment is)
+                // If prev is to our left, input comes from left, etc.
+                newSeg->inputDirection = static_cast<CoordDirection>(i);
+                
+                // (We break after the first input found to keep it simple)
+                break; 
+            }
+        }
+
+        // --- 2. FORWARD SNAP (Outputs) ---
+        // Look at where we are pointing.
+        tx::Coord targetPos = pos + delta;
+        if (valid_impl(targetPos)) {
+            ConveyorSegment* target = tiles.at(targetPos).getConveyor();
+            if (target) {
+                // We feed them.
+                newSeg->nextsegment = target;
+                newSeg->nextInOtherChunk = chunkOf_impl(pos) != chunkOf_impl(targetPos);
+                
+                // AUTO-CORNER LOGIC:
+                // Snap their Start (p1) to our End (p2).
+                // This dynamically turns a straight belt into a corner if we side-load it!
+                target->p1 = newSeg->p2;
+                
+                // Update target's input direction (opposite of our direction = direction we're coming from)
+                // We're at 'pos', target is at 'targetPos', so target's input comes from direction opposite to 'dir'
+                // Actually, the input direction is where we are relative to target
+                // We placed at 'pos', and we point to 'targetPos', so from target's perspective, input comes from 'pos'
+                // That means input direction is the opposite of 'dir'
+                switch (dir) {
+                    case CoordDirection::Right: target->inputDirection = CoordDirection::Left; break;
+                    case CoordDirection::Left: target->inputDirection = CoordDirection::Right; break;
+                    case CoordDirection::Top: target->inputDirection = CoordDirection::Bottom; break;
+                    case CoordDirection::Bottom: target->inputDirection = CoordDirection::Top; break;
+                    default: break;
+                }
+            }
+        }
+
+        relinkInserters(pos);
+        relinkExtractors(pos);
+        return true;
+    }
+
+    // memory: where the path is allocated, a frame or tick tx::BumpArena for paths that are thrown away soon
+    static std::pmr::vector<BuildStep> calculatePath(tx::Coord start, tx::Coord end,
+                                                     std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        std::pmr::vector<BuildStep> path{ memory };
+        path.reserve(std::abs(end.x() - start.x()) + std::abs(end.y() - start.y()) + 1);
+        int dx = end.x() - start.x();
+        int dy = end.y() - start.y();
+
+        tx::Coord current = start;
+
+        int xSteps = std::abs(dx);
+        int ySteps = std::abs(dy);
+        
+        CoordDirection xDir = (dx >= 0) ? CoordDirection::Right : CoordDirection::Left;
+        CoordDirection yDir = (dy >= 0) ? CoordDirection::Top : CoordDirection::Bottom;
+
+        // Handle horizontal movement - all horizontal tiles point in the horizontal direction
+        for (int i = 0; i < xSteps; i++) {
+            path.push_back({current, xDir});
+            current = current + dirToCoord(xDir);
+        }
+
+        // Handle vertical movement - all vertical tiles point in the vertical direction
+        for (int i = 0; i < ySteps; ++i) {
+            path.push_back({current, yDir});
+            current = current + dirToCoord(yDir);
+        }
+
+        // If start == end, place a single tile
+        if (path.empty()) {
+            path.push_back({start, CoordDirection::Right});
+        }
+
+        return path;
+    }
+
+    void placeExtractor(const tx::Coord& pos, CoordDirection outputDir, uint8_t outputSides = Extractor::AllSides) {
+        if (!valid_impl(pos)) return;
+        Tile& tile = tiles.at(pos);
+        
+        // Can only place extractors on ore tiles
+        if (tile.type() == TileType::Space) {
+            return;  // Not an ore tile
+        }
+        
+        // Check if there's already an extractor here
+        if (tile.getExtractor()) {
+            return;  // Already has extractor
+        }
+        
+        // Create the extractor - output ports are resolved now and whenever a neighbouring belt is built
+        Extractor& extractor = extractors[extractors.create()];
+        extractor.pos = pos;
+        extractor.oreType = tile.type();
+        extractor.deposit = findOreAmount_impl(pos);
+        extractor.outputDir = outputDir;
+        extractor.outputSides = outputSides;
+        
+        tile.setExtractor(&extractor);
+        computeExtractorPorts_impl(extractor);
+        extractor.behavior = runExtractor_impl(extractor);
+        scheduler.start(extractor.behavior);
+    }
+
+    void placeStorage(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        Storage* storage = &storages[storages.create()];
+        storage->pos = pos;
+        tiles.at(pos).setStorage(storage);
+        flowFields.setBlocked(tiles.index(pos), true);
+
+        relinkInserters(pos);
+    }
+
+    void placeCrafter(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        BuildingStore<Crafter>::Id id = crafters.create();
+        Crafter* crafter = &crafters[id];
+        crafter->storeId = id;
+        crafter->pos = pos;
+        tiles.at(pos).setCrafter(crafter);
+        addCrafter_impl(crafter);
+        power.add(tiles.index(pos), 0.0f);
+        flowFields.setBlocked(tiles.index(pos), true);
+
+        relinkInserters(pos);
+    }
+
+    void placeGenerator(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        BuildingStore<Generator>::Id id = generators.create();
+        Generator* generator = &generators[id];
+        generator->storeId = id;
+        generator->pos = pos;
+        tiles.at(pos).setGenerator(generator);
+        power.add(tiles.index(pos), generator->output);
+        flowFields.setBlocked(tiles.index(pos), true);
+    }
+
+    void placePole(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        BuildingStore<PowerPole>::Id id = poles.create();
+        PowerPole* pole = &poles[id];
+        pole->storeId = id;
+        pole->pos = pos;
+        tiles.at(pos).setPole(pole);
+        power.add(tiles.index(pos), 0.0f);
+    }
+
+    // Refinery: a crafter that joins both the power grid and the pipe run it touches
+    void placeRefinery(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        BuildingStore<Crafter>::Id id = crafters.create();
+        Crafter* refinery = &crafters[id];
+        refinery->storeId = id;
+        refinery->pos = pos;
+        refinery->makeRefinery();
+        tiles.at(pos).setCrafter(refinery);
+        addCrafter_impl(refinery);
+        flowFields.setBlocked(tiles.index(pos), true);
+        power.add(tiles.index(pos), 0.0f);
+        fluids.add(tiles.index(pos), 0.0f);
+
+        relinkInserters(pos);
+    }
+
+    void placePipe(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        BuildingStore<Pipe>::Id id = pipes.create();
+        Pipe* pipe = &pipes[id];
+        pipe->storeId = id;
+        pipe->pos = pos;
+        tiles.at(pos).setPipe(pipe);
+        fluids.add(tiles.index(pos), 0.0f);
+    }
+
+    void placePump(const tx::Coord& pos) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        BuildingStore<Pump>::Id id = pumps.create();
+        Pump* pump = &pumps[id];
+        pump->storeId = id;
+        pump->pos = pos;
+        tiles.at(pos).setPump(pump);
+        flowFields.setBlocked(tiles.index(pos), true);
+        fluids.add(tiles.index(pos), pump->rate);
+    }
+
+    // Removes a power or fluid building; only the networks it belonged to are rebuilt
+    void removeBuilding(const tx::Coord& pos) {
+        if (!valid_impl(pos)) return;
+        Tile& tile = tiles.at(pos);
+        if (Pipe* pipe = tile.getPipe()) {
+            tile.setPipe(nullptr);
+            pipes.destroy(pipe->storeId);
+            fluids.remove(tiles.index(pos));
+            return;
+        }
+        if (Pump* pump = tile.getPump()) {
+            tile.setPump(nullptr);
+            flowFields.setBlocked(tiles.index(pos), false);
+            pumps.destroy(pump->storeId);
+            fluids.remove(tiles.index(pos));
+            return;
+        }
+        if (Crafter* crafter = tile.getCrafter()) {
+            tile.setCrafter(nullptr);
+            flowFields.setBlocked(tiles.index(pos), false);
+            relinkInserters(pos);  // unparks inserters sleeping on the crafter
+            chunks[chunkOf_impl(pos)].crafters.remove(crafter);
+            crafters.destroy(crafter->storeId);
+        } else if (Generator* generator = tile.getGenerator()) {
+            tile.setGenerator(nullptr);
+            flowFields.setBlocked(tiles.index(pos), false);
+            generators.destroy(generator->storeId);
+        } else if (PowerPole* pole = tile.getPole()) {
+            tile.setPole(nullptr);
+            poles.destroy(pole->storeId);
+        } else {
+            return;
+        }
+        power.remove(tiles.index(pos));
+        fluids.remove(tiles.index(pos));  // no-op unless it was a refinery
+    }
+
+    // Inserter picks up from the tile behind it and drops to the tile it faces
+    void placeInserter(const tx::Coord& pos, CoordDirection dir) {
+        if (!valid_impl(pos) || isOccupied(pos)) return;
+
+        Inserter* inserter = &inserters[inserters.create()];
+        inserter->pos = pos;
+        inserter->dir = dir;
+        tiles.at(pos).setInserter(inserter);
+
+        inserter->source = findEndpoint_impl(inserter->pickupPos());
+        inserter->target = findEndpoint_impl(inserter->dropPos());
+        inserter->behavior = inserter->run(scheduler);
+        scheduler.start(inserter->behavior);
+    }
+
+    // Signals (see SignalNetwork): storages report their item total, combinators compute on
+    // signals, inserters can be switched on and off by one. Nodes are wired by the ids returned here.
+    SignalNetwork::Node storageSignal(const tx::Coord& pos) {
+        if (!valid_impl(pos)) return SignalNetwork::None;
+        Storage* storage = tiles.at(pos).getStorage();
+        if (!storage) return SignalNetwork::None;
+        if (!storage->signals) {
+            storage->signals = &signals;
+            storage->signal = signals.addInput(storage->total);
+        }
+        return storage->signal;
+    }
+    SignalNetwork::Node addSignalInput(int value = 0) { return signals.addInput(value); }
+    SignalNetwork::Node addCombinator(SignalNetwork::Op op, const vector<SignalNetwork::Node>& inputs,
+                                      std::optional<int> constant = std::nullopt) {
+        if (op == SignalNetwork::Op::Input) return SignalNetwork::None;
+        for (SignalNetwork::Node input : inputs) {
+            if (!validSignal_impl(input)) return SignalNetwork::None;
+        }
+        return signals.addCombinator(op, inputs, constant);
+    }
+    // Input nodes only (addSignalInput), false for anything else; the new value reaches readers in the next tick
+    bool setSignal(SignalNetwork::Node node, int value) {
+        return validSignal_impl(node) && signals.set(node, value);
+    }
+    int signalValue(SignalNetwork::Node node) const { return validSignal_impl(node) ? signals.value(node) : 0; }
+    // The inserter at pos only picks up while node is not 0; None switches it back to always on
+    bool setInserterCondition(const tx::Coord& pos, SignalNetwork::Node node) {
+        if (!valid_impl(pos) || (node != SignalNetwork::None && !validSignal_impl(node))) return false;
+        Inserter* inserter = tiles.at(pos).getInserter();
+        if (!inserter) return false;
+        inserter->signals = &signals;
+        inserter->enableSignal = node;
+        scheduler.interrupt(inserter->behavior);
+        return true;
+    }
+
+    bool isOccupied(const tx::Coord& pos) const {
+        const Tile& tile = tiles.at(pos);
+        return tile.getConveyor() || tile.getStorage() || tile.getInserter() || tile.getExtractor()
+            || tile.getCrafter() || tile.getGenerator() || tile.getPole() || tile.getPipe() || tile.getPump();
+    }
+    bool valid(const tx::Coord& pos) const { return valid_impl(pos); }
+
+    // read access for the renderer and tools
+    int getMapSize() const { return MapSize; }
+    float getTickTime() const { return TickTime; }  // seconds simulated per update()
+    uint64_t getTick() const { return scheduler.tick; }
+    TaskGraph& getTickGraph() { return tickGraph; }
+    const tx::GridSystem<Tile>& getTiles() const { return tiles; }
+    const vector<TileIndex>& getOres() const { return ores; }
+    const BuildingStore<ConveyorSegment>& getConveyors() const { return conveyorBelts; }
+    const BuildingStore<Extractor>& getExtractors() const { return extractors; }
+    const BuildingStore<Storage>& getStorages() const { return storages; }
+    const BuildingStore<Inserter>& getInserters() const { return inserters; }
+    const BuildingStore<Crafter>& getCrafters() const { return crafters; }
+    const BuildingStore<Generator>& getGenerators() const { return generators; }
+    const BuildingStore<PowerPole>& getPoles() const { return poles; }
+    const BuildingStore<Pipe>& getPipes() const { return pipes; }
+    const BuildingStore<Pump>& getPumps() const { return pumps; }
+    const vector<Drone>& getDrones() const { return drones.data(); }
+    float powerSatisfaction(const tx::Coord& pos) { return power.satisfaction(tiles.index(pos)); }
+    float fluidFill(const tx::Coord& pos) { return fluids.fill(tiles.index(pos)); }
+    const SignalNetwork& getSignals() const { return signals; }
+    const std::deque<Statistics>& getStatistics() const { return statistics; }  // oldest first
+    int getStatisticsInterval() const { return statisticsInterval; }
+
+    // Chunks overlapping the tiles in [min, max] are simulated every tick; min > max leaves none.
+    // The others are brought up to date every CoarseInterval ticks, a chunk at a time: the belts
+    // replay the ticks since the chunk's last update one by one and crafters carry the time past a
+    // finished ingot into the next, so inside the chunk the result is what ticking every tick
+    // gives. What is batched is the chunk's contact with the rest: items cross its border, and
+    // inserters see its belts change, only at those updates, up to CoarseInterval - 1 ticks off.
+    // A chunk back in view replays the ticks it skipped at its next update and runs every tick
+    // from then on.
+    void setViewport(const tx::Coord& min, const tx::Coord& max) {
+        for (int c = 0; c < static_cast<int>(chunks.size()); ++c) {
+            int x = (c % chunksX) * ChunkSize, y = (c / chunksX) * ChunkSize;
+            chunks[c].detailed = x <= max.x() && x + ChunkSize > min.x() && y <= max.y() && y + ChunkSize > min.y();
+        }
+    }
+    // whether pos lies in a chunk simulated every tick
+    bool detailed(const tx::Coord& pos) const { return chunks[chunkOf_impl(pos)].detailed; }
+
+    // Hash of the simulation state after the last tick: belts and their items, extractors, ore
+    // left in the tiles, storages, crafters, inserters, drones and their cargo, generators, poles,
+    // pumps, the supply, demand and satisfaction of every powered tile's network, fluid levels and
+    // signals. Sleeping behaviors count through the tick they wake at. Not covered: the random
+    // streams (only split during generation) and the flow fields, which drones' positions follow.
+    // A full pass over the state, O(buildings + items), not kept up to date as the state changes:
+    // meant for checks, which is why the checksum only takes it every checksumInterval ticks.
+    uint64_t hashState() {
+        StateHash hash;
+        hash.add(scheduler.tick);
+        for (const ConveyorSegment& seg : conveyorBelts) {
+            hash.add(seg.tilePos).add(static_cast<uint32_t>(seg.entities.size()));
+            for (const Entity& entity : seg.entities) hash.add(entity.distance).add(entity.id);
+        }
+        for (const Extractor& extractor : extractors) {
+            hash.add(extractor.pos).add(extractor.holding).add(extractor.nextPort).add(extractor.mineEndTick);
+        }
+        for (size_t i = 0; i < ores.size(); ++i) {
+            hash.add(ores[i]).add(oreAmounts[i]).add(static_cast<int>(tiles.atIndex(ores[i]).type()));
+        }
+        for (const Storage& storage : storages) {
+            hash.add(storage.pos);
+            for (int count : storage.counts) hash.add(count);
+        }
+        for (const Crafter& crafter : crafters) {
+            hash.add(crafter.pos).add(crafter.recipe).add(crafter.progress).add(crafter.fluid);
+            for (int count : crafter.inputs) hash.add(count);
+            for (int count : crafter.outputs) hash.add(count);
+        }
+        for (const Inserter& inserter : inserters) {
+            hash.add(inserter.pos).add(static_cast<uint8_t>(inserter.state)).add(inserter.holding)
+                .add(inserter.heldItem).add(inserter.swingEndTick);
+        }
+        for (const Drone& drone : drones.data()) {
+            hash.add(drone.pos).add(drone.vel).add(drone.destination).add(drone.mission).add(drone.carrying).add(drone.item);
+        }
+        auto hashPower = [&](const tx::Coord& pos) {
+            int index = tiles.index(pos);
+            hash.add(power.networkSupply(index)).add(power.networkDemand(index)).add(power.satisfaction(index));
+        };
+        for (const Crafter& crafter : crafters) hashPower(crafter.pos);
+        for (const Generator& generator : generators) {
+            hash.add(generator.pos).add(generator.output);
+            hashPower(generator.pos);
+        }
+        for (const PowerPole& pole : poles) {
+            hash.add(pole.pos);
+            hashPower(pole.pos);
+        }
+        for (const Pump& pump : pumps) hash.add(pump.pos).add(pump.rate).add(fluidFill(pump.pos));
+        for (const Pipe& pipe : pipes) hash.add(pipe.pos).add(fluidFill(pipe.pos));
+        for (SignalNetwork::Node node = 0; node < signals.size(); ++node) hash.add(signals.value(node));
+        return hash.value();
+    }
+
+    // Chained hashState() of every interval-th tick since enableChecksum(); worlds that went
+    // through a different state at any of those ticks disagree from then on. Each one costs a
+    // full hashState(), so the interval bounds the cost. log prints the checksum each time
+    // (config: Simulation.checksumLog, the interval).
+    // Flow fields then publish on fixed ticks, waiting for the coordinator if need be, so drones
+    // fly the same way whatever the thread timing.
+    void enableChecksum(int interval = 1, bool log = false) {
+        checksumInterval = std::max(interval, 1);
+        checksumLog = log;
+        flowFields.setWaitForResults(true);
+    }
+    uint64_t getChecksum() const { return checksum; }
+    uint32_t getSeed() const { return seed; }
+    tx::Random randomStream(RandomStream stream) const { return random.split(static_cast<uint64_t>(stream)); }
+
+    // Deposits that ran out since the last call (their tiles are Space now)
+    vector<tx::Coord> takeExhaustedDeposits() { return std::exchange(exhaustedDeposits, {}); }
+
+private:
+    // runtime data
+    BuildingStore<ConveyorSegment> conveyorBelts;
+    BuildingStore<Extractor> extractors;
+    
+    BuildingStore<Storage> storages;
+    BuildingStore<Inserter> inserters;
+    BehaviorScheduler scheduler;
+
+    BuildingStore<Crafter> crafters;
+    BuildingStore<Generator> generators;
+    BuildingStore<PowerPole> poles;
+    PowerGrid power;
+
+    BuildingStore<Pipe> pipes;
+    BuildingStore<Pump> pumps;
+    FluidSystem fluids;
+
+    SignalNetwork signals;
+
+    struct DroneRoute {
+        Storage* from;
+        Storage* to;
+    };
+    vector<DroneRoute> droneRoutes;  // indexed by Drone::mission
+    DroneSwarm drones;
+    FlowFieldCache flowFields;
+
+    // Grid tracking conveyor directions for each tile (None = no conveyor)
+    tx::GridSystem<CoordDirection> conveyorDirections;
+
+    // Buildings updated every tick, grouped by map chunk so chunks can be updated in parallel.
+    // Whatever a chunk does to buildings or networks outside of it is queued and applied after
+    // all chunks ran, in chunk order, so the result does not depend on the thread count.
+    // Only belts and crafters are split this way. Storages have no update of their own, and
+    // extractors and inserters are behaviors: a tick resumes just the few whose timer or wait
+    // came due, far below MinWorkPerJob. Each of those takes from and drops into belts, storages
+    // and crafters that may lie in other chunks, wakes their waiters and writes storage signals,
+    // and when two compete for an item or a free belt entry the scheduler's resume order decides.
+    // Deferring all of that like the belt handoffs would cost more than the resumes themselves,
+    // so they run serially in the behaviors phase.
+    struct BuildingChunk {
+        ActiveList<ConveyorSegment> belts;  // the ones carrying items first
+        ActiveList<Crafter> crafters;       // the ones with ore or a recipe first
+        vector<std::pair<int, float>> steps; // per active crafter: ticks to simulate (0 = not due) and power satisfaction
+        vector<ConveyorSegment*> handoffs;                // head items moving to another chunk
+        vector<std::pair<Crafter*, float>> demandChanges; // applied to the shared power grid
+        vector<BehaviorHandle> woken;
+
+        bool detailed = true;  // in view: simulated every tick (see setViewport)
+        int phase = 0;         // tick offset of the coarse updates, spreads them over the interval
+        // first tick not simulated yet, per phase of the tick graph (they may run side by side)
+        uint64_t beltsUntil = 0, craftersUntil = 0;
+        int crafterTicks = 0;  // ticks since the chunk's last crafter update, 0 = none this tick
+        int nextCrafterPhase = 0;
+
+        // ticks to simulate at tick, 0 while an off-screen chunk waits for its turn
+        int due(uint64_t tick, uint64_t& until) const {
+            if (!detailed && (tick + phase) % CoarseInterval != 0) return 0;
+            int ticks = static_cast<int>(tick + 1 - until);
+            until = tick + 1;
+            return ticks;
+        }
+    };
+    static constexpr int ChunkSize = 16;       // tiles per chunk side
+    static constexpr int CoarseInterval = 8;   // ticks between updates of a chunk out of view
+    static constexpr int MinWorkPerJob = 256;  // buildings per job below which a job costs more than it saves
+    vector<BuildingChunk> chunks;
+    int chunksX = 1;
+
+    // tick phases and the data they touch
+    enum TickData : TaskGraph::Resources {
+        PowerData   = 1 << 0,
+        FluidData   = 1 << 1,
+        BeltData    = 1 << 2,
+        CrafterData = 1 << 3,
+        DroneData   = 1 << 4,
+        StorageData = 1 << 5,
+        WakeData    = 1 << 6,  // scheduler.ready: behaviors woken during the tick
+        SignalData  = 1 << 7
+    };
+    TaskGraph tickGraph;
+    tx::JobSystem jobSystem;
+
+    tx::GridSystem<Tile> tiles;
+    vector<TileIndex> ores; // sorted tile indices of ore tiles
+    vector<int> oreAmounts; // remaining ore per entry of ores (sparse: only ore tiles store an amount)
+    vector<tx::Coord> exhaustedDeposits;
+
+    int MapSize = 16;
+    float TickTime = 1.0f / 60.0f;  // config: Simulation.tickRate (ticks per second)
+    uint32_t seed;
+
+    int checksumInterval = 0;  // ticks between hashState() calls, 0 = off
+    bool checksumLog = false;
+    uint64_t checksum = 0;
+
+    // ticks between updates of the subsystems not run every tick (config Simulation.*Rate, per second)
+    int crafterInterval = 4;
+    int statisticsInterval = 60;
+    std::deque<Statistics> statistics;
+
+private:
+    // utility
+    tx::Random random;  // root stream, only split (see RandomStream)
+    
+    // Chunks move their belts in parallel; a head item crossing into another chunk waits in the
+    // chunk's handoff queue, and the queues are emptied in chunk order once all chunks are done.
+    // Off-screen chunks move theirs every CoarseInterval ticks only (see setViewport).
+    void updateConveyor(float dt) {
+        uint64_t tick = scheduler.tick;
+        int work = 0;
+        for (const BuildingChunk& chunk : chunks) work += static_cast<int>(chunk.belts.active());
+        forEachChunk_impl(work, [dt, tick](BuildingChunk& chunk) {
+            int ticks = chunk.due(tick, chunk.beltsUntil);
+            // the ticks since the chunk's last update, one by one: a segment hands over at most one
+            // item per update, longer steps would hold items back at every segment end
+            for (int step = ticks - 1; step >= 0; --step) moveBelts_impl(chunk, dt, tick - step, step == 0);
+        });
+        for (BuildingChunk& chunk : chunks) {
+            for (ConveyorSegment* segment : chunk.handoffs) {
+                if (!segment->nextsegment->isEntryBlocked()) segment->handOver();
+            }
+            chunk.handoffs.clear();
+        }
+    }
+
+    // One tick of a chunk's belts; only the last tick of a batch queues the handoffs to other chunks.
+    // An emptied belt drops out of the active part until an item arrives (ConveyorSegment::push).
+    static void moveBelts_impl(BuildingChunk& chunk, float dt, uint64_t tick, bool last) {
+        for (size_t i = 0; i < chunk.belts.active();) {
+            ConveyorSegment* segment = chunk.belts[i];
+            if (segment->update(dt, ConveyorSpeed, static_cast<uint16_t>(tick)) && last) chunk.handoffs.push_back(segment);
+            if (segment->entities.empty()) chunk.belts.deactivate(segment);
+            else ++i;
+        }
+    }
+
+    // crafters of a chunk take the phases in turn, so as many are due on every tick
+    void addCrafter_impl(Crafter* crafter) {
+        BuildingChunk& chunk = chunks[chunkOf_impl(crafter->pos)];
+        crafter->phase = chunk.nextCrafterPhase;
+        chunk.nextCrafterPhase = (chunk.nextCrafterPhase + 1) % crafterInterval;
+        crafter->until = scheduler.tick;
+        chunk.crafters.add(crafter);
+    }
+
+    // a subsystem running rate times per second runs every this many ticks
+    int intervalFor_impl(int rate) const {
+        return std::max(1, static_cast<int>(std::lround(1.0f / (std::max(rate, 1) * TickTime))));
+    }
+
+    int chunkOf_impl(const tx::Coord& pos) const {
+        return (pos.y() / ChunkSize) * chunksX + pos.x() / ChunkSize;
+    }
+
+    // func(chunk) for every chunk; work (buildings to update) decides how many jobs are worth it
+    template<class Func>
+    void forEachChunk_impl(int work, const Func& func) {
+        int count = static_cast<int>(chunks.size());
+        int jobs = std::clamp(work / MinWorkPerJob, 1, 4 * (jobSystem.threadAmount() + 1));
+        jobSystem.parallel_for(0, count, (count + jobs - 1) / jobs, [&](int begin, int end) {
+            for (int c = begin; c < end; ++c) func(chunks[c]);
+        });
+    }
+
+    // behaviors woken inside a chunk join the ready list in chunk order, once each
+    void queueWoken_impl(vector<BehaviorHandle>& woken) {
+        for (BehaviorHandle handle : woken) {
+            if (handle.promise().queued) continue;
+            handle.promise().queued = true;
+            scheduler.ready.push_back(handle);
+        }
+        woken.clear();
+    }
+
+    void setOreTile_impl(const tx::Coord& pos, TileType type) {
+        if(!valid_impl(pos)) return;
+        tiles.at(pos).setType(type);
+        int index = tiles.index(pos);
+        ores.push_back(index);
+    }
+
+
+
+    void genOreTiles_impl(const tx::JsonObject& cfg) {
+        genOre_impl(cfg, "PolicyCommon", TileType::Ore_Coal);
+        initOreAmounts_impl(cfg);
+    }
+    // must be after all ore gen, ores stays sorted and unchanged afterwards
+    void initOreAmounts_impl(const tx::JsonObject& cfg) {
+        int amountMin = cfg["OreGeneration"]["depositAmountMin"].get<int>();
+        int amountMax = cfg["OreGeneration"]["depositAmountMax"].get<int>();
+        // per tile, so a tile's amount does not depend on how many ore tiles precede it
+        tx::Random amountRandom = randomStream(RandomStream::OreAmounts);
+        oreAmounts.resize(ores.size());
+        for (size_t i = 0; i < ores.size(); ++i) {
+            oreAmounts[i] = amountRandom.split(ores[i]).uniform(amountMin, amountMax);
+        }
+    }
+    int* findOreAmount_impl(const tx::Coord& pos) {
+        TileIndex index = tiles.index(pos);
+        auto it = std::lower_bound(ores.begin(), ores.end(), index);
+        if (it == ores.end() || *it != index) return nullptr;
+        return &oreAmounts[it - ores.begin()];
+    }
+    void genOre_impl(const tx::JsonObject& cfg, const string& policy, TileType type) {
+        const tx::JsonObject& policyCfg = cfg["OreGeneration"][policy].get<tx::JsonObject>();
+        tx::Bitmap circle;
+        float radius = [&](){
+            float r = policyCfg["radius"].get<float>();
+            tx::GridCircle gc{r};
+            gc.getBitMap(tx::CoordOrigin, circle);
+            return r;
+        }();
+        tx::Bitmap surroundingCircle;
+        float surroundingRadius = [&](){
+            float sr = policyCfg["surroundingClusterRadius"].get<float>();
+            tx::GridCircle gc{sr};
+            gc.getBitMap(tx::CoordOrigin, surroundingCircle);
+            return sr;
+        }();
+        int offsetMin = policyCfg["surroundingClusterOffsetMin"].get<int>();
+        int offsetMax = policyCfg["surroundingClusterOffsetMax"].get<int>();
+        tx::Random typeRandom = randomStream(RandomStream::OreClusters).split(static_cast<uint64_t>(type));
+        
+        int clusterAmount = policyCfg["clusterAmount"].get<int>();
+        for(int i = 0; i < clusterAmount; ++i){
+            tx::Random clusterRandom = typeRandom.split(i);
+            tx::Coord center = getRandCoord_impl(clusterRandom);
+            int surroundingClusterAmount = policyCfg["surroundingClusterAmount"].get<int>();
+            //cout << surroundingClusterAmount << endl;
+            vector<tx::Coord> surroundingCenters(surroundingClusterAmount);
+            for(tx::Coord& i : surroundingCenters){
+                int dx = clusterRandom.uniform(-1, 1) * clusterRandom.uniform(offsetMin, offsetMax);
+                int dy = clusterRandom.uniform(-1, 1) * clusterRandom.uniform(offsetMin, offsetMax);
+                i = center.offset(dx, dy);
+            }
+
+            auto setOreTiles = [&](const tx::Coord& pos, const tx::Bitmap& map){
+                for(const tx::Coord& i : map){
+                    setOreTile_impl(i + pos, type);
+                }
+            };
+            
+            setOreTiles(center, circle);
+            for(const tx::Coord& i : surroundingCenters){
+                setOreTiles(i, surroundingCircle);
+            }
+        }
+        std::sort(ores.begin(), ores.end());
+        ores.erase(std::unique(ores.begin(), ores.end()), ores.end());
+    }
+
+
+    tx::Coord getRandCoord_impl(tx::Random& in_random) {
+        int x = in_random.uniform(0, MapSize - 1);
+        return tx::Coord{x, in_random.uniform(0, MapSize - 1)};
+    }
+    bool valid_impl(const tx::Coord& in) const {
+        return tx::inRange(in, tx::CoordOrigin, tx::Coord{MapSize});
+    }
+    bool validSignal_impl(SignalNetwork::Node node) const {
+        return node >= 0 && node < signals.size();
+    }
+
+    // Extractor loop: mine one item per interval, hold it until a port is free.
+    // Without ports or ore left it parks until relinked and costs nothing.
+    Behavior runExtractor_impl(Extractor& extractor) {
+        for (;;) {
+            if (extractor.portCount == 0 || (extractor.depleted() && !extractor.holding)) {
+                co_await scheduler.until(extractor.linkWaiters);
+                continue;
+            }
+            if (!extractor.holding) {
+                extractor.mineEndTick = scheduler.tick + scheduler.ticksFor(extractor.extractInterval);
+                co_await scheduler.sleep(scheduler.ticksFor(extractor.extractInterval));
+                extractor.holding = true;
+                if (extractor.deposit && --(*extractor.deposit) <= 0) {
+                    exhaustDeposit_impl(extractor.pos);
+                }
+            }
+            if (!extractor.tryOutput()) {
+                co_await scheduler.anySpace(extractor.ports.data(), extractor.portCount);
+            }
+        }
+    }
+
+    // Power, fluids, belts and drone flight are independent; crafters wait for their networks,
+    // phases that wake behaviors share the ready list, signals settle what storages reported and
+    // behaviors run last on their own. Crafters pace themselves (crafterInterval), statistics run
+    // at their own interval.
+    void buildTickGraph_impl() {
+        tickGraph.add("power",          0, PowerData, [this]() { power.update(); });
+        tickGraph.add("fluids",         0, FluidData, [this]() { fluids.update(TickTime); });
+        tickGraph.add("belts",          0, BeltData,  [this]() { updateConveyor(TickTime); });
+        tickGraph.add("drone flight",   0, DroneData, [this]() { updateDroneFlight(TickTime); });
+        tickGraph.add("crafters",       0, PowerData | FluidData | CrafterData | WakeData, [this]() { updateCrafters(TickTime); });
+        tickGraph.add("drone arrivals", 0, DroneData | StorageData | SignalData | WakeData, [this]() { updateDroneArrivals(); });
+        tickGraph.add("signals",        0, SignalData | WakeData, [this]() { signals.update(scheduler.ready); });
+        tickGraph.add("statistics",     BeltData | CrafterData | StorageData, 0, [this]() { sampleStatistics_impl(); }, statisticsInterval);
+        tickGraph.add("behaviors",      0, TaskGraph::AllResources, [this]() { scheduler.update(); });
+        tickGraph.add("checksum",       TaskGraph::AllResources, 0, [this]() { updateChecksum_impl(); });
+    }
+
+    void sampleStatistics_impl() {
+        Statistics sample;
+        sample.tick = scheduler.tick;
+        for (const Storage& storage : storages) sample.storedItems += storage.total;
+        for (const ConveyorSegment& seg : conveyorBelts) sample.beltItems += static_cast<int>(seg.entities.size());
+        for (const Crafter& crafter : crafters) sample.workingCrafters += crafter.working();
+        if (statistics.size() == StatisticsHistory) statistics.pop_front();
+        statistics.push_back(sample);
+    }
+
+    void updateChecksum_impl() {
+        if (checksumInterval == 0 || scheduler.tick % checksumInterval != 0) return;
+        checksum = StateHash::mix(checksum ^ hashState());
+        if (checksumLog) {
+            cout << "[Checksum]: tick " << scheduler.tick << " " << std::hex << checksum << std::dec << "\n";
+        }
+    }
+
+    // The deposit at pos ran out: the tile becomes ground, the renderer re-tiles around it
+    void exhaustDeposit_impl(const tx::Coord& pos) {
+        tiles.at(pos).setType(TileType::Space);
+        exhaustedDeposits.push_back(pos);
+    }
+
+    ItemEndpoint findEndpoint_impl(const tx::Coord& pos) {
+        ItemEndpoint endpoint;
+        if (!valid_impl(pos)) return endpoint;
+        const Tile& tile = tiles.at(pos);
+        endpoint.belt = tile.getConveyor();
+        if (!endpoint.belt) endpoint.storage = tile.getStorage();
+        if (!endpoint.belt && !endpoint.storage) endpoint.crafter = tile.getCrafter();
+        return endpoint;
+    }
+
+    // Re-resolve an inserter's endpoints; if it is parked it wakes up and re-checks them
+    void linkInserter_impl(Inserter* inserter) {
+        scheduler.interrupt(inserter->behavior);
+        inserter->source = findEndpoint_impl(inserter->pickupPos());
+        inserter->target = findEndpoint_impl(inserter->dropPos());
+    }
+
+    // Port order starts at the extractor's outputDir; belts pointing into the extractor are inputs, not ports
+    void computeExtractorPorts_impl(Extractor& extractor) {
+        std::array<ConveyorSegment*, 4> ports{};
+        int count = 0;
+        int first = static_cast<int>(extractor.outputDir) % 4;
+        for (int k = 0; k < 4; ++k) {
+            int side = (first + k) % 4;
+            if (!(extractor.outputSides & (1 << side))) continue;
+            tx::Coord neighborPos = extractor.pos + dirToCoord(static_cast<CoordDirection>(side));
+            if (!valid_impl(neighborPos)) continue;
+            ConveyorSegment* belt = tiles.at(neighborPos).getConveyor();
+            if (!belt || neighborPos + dirToCoord(belt->direction) == extractor.pos) continue;
+            ports[count++] = belt;
+        }
+        extractor.setPorts(ports, count);
+        scheduler.interrupt(extractor.behavior);
+    }
+
+    // A belt appeared at pos: neighbouring extractors recompute their ports
+    void relinkExtractors(const tx::Coord& pos) {
+        for (int i = 0; i < 4; ++i) {
+            tx::Coord neighborPos = pos + dirToCoord(static_cast<CoordDirection>(i));
+            if (!valid_impl(neighborPos)) continue;
+            if (Extractor* extractor = tiles.at(neighborPos).getExtractor()) {
+                computeExtractorPorts_impl(*extractor);
+            }
+        }
+    }
+
+    // A building appeared at pos: inserters facing it re-resolve their endpoints
+    void relinkInserters(const tx::Coord& pos) {
+        for (int i = 0; i < 4; ++i) {
+            tx::Coord neighborPos = pos + dirToCoord(static_cast<CoordDirection>(i));
+            if (!valid_impl(neighborPos)) continue;
+            Inserter* inserter = tiles.at(neighborPos).getInserter();
+            if (inserter && (inserter->pickupPos() == pos || inserter->dropPos() == pos)) {
+                linkInserter_impl(inserter);
+            }
+        }
+    }
+};
@@ -0,0 +1,103 @@
+#include "World.hpp"
+
+// Simulation without a window: generates a world, builds a benchmark layout on it and ticks it.
+// Usage: WinHacksHeadless [ticks] [mapSize] [viewSize] [--verify]   (run from the repository root, like WinHacks)
+// viewSize: side of the square of tiles at the origin simulated every tick, the whole map by default
+// --verify: also ticks a single-threaded copy of the world and compares their checksums every tick
+
+// A belt every third row, emptied into a storage by an inserter at its end; extractors on every ore tile next to a belt
+void buildBenchmarkLayout(World& world) {
+	int size = world.getMapSize();
+	for (int y = 1; y < size; y += 3) {
+		for (const World::BuildStep& step : world.calculatePath({ 0, y }, { size - 2, y })) {
+			world.placeConveyor(step.pos, step.dir);
+		}
+		world.placeInserter({ size - 2, y }, CoordDirection::Right);
+		world.placeStorage({ size - 1, y });
+	}
+	for (int y = 0; y < size; ++y) {
+		if (y % 3 == 1) continue;
+		for (int x = 0; x < size - 2; ++x) {
+			if (world.getTiles().at({ x, y }).type() != TileType::Space) {
+				world.placeExtractor({ x, y }, CoordDirection::Right);
+			}
+		}
+	}
+}
+
+// Drones between neighbouring storages of the benchmark layout, so flow fields get built
+void addDroneTraffic(World& world) {
+	int size = world.getMapSize();
+	for (int y = 1, routes = 0; y + 3 < size && routes < 6; y += 3, ++routes) {
+		world.addDroneRoute({ size - 1, y }, { size - 1, y + 3 }, 2);
+	}
+}
+
+// Ticks world next to a reference built with the same seed on the calling thread only, and
+// reports the first tick their states differ in. Both get drone traffic and, at VerifyPlacementTick,
+// a generator in the drones' way, whose flow field repairs must show up on the same tick in both.
+constexpr int VerifyPlacementTick = 50;
+bool verify(const tx::JsonObject& cfg, World& world, int ticks, int viewSize) {
+	World reference{ cfg, world.getMapSize(), 0, world.getSeed() };
+	buildBenchmarkLayout(reference);
+	reference.setViewport({ 0, 0 }, { viewSize - 1, viewSize - 1 });
+	addDroneTraffic(world);
+	addDroneTraffic(reference);
+	world.enableChecksum();
+	reference.enableChecksum();
+	for (int i = 0; i < ticks; ++i) {
+		if (i == VerifyPlacementTick) {
+			tx::Coord pos{ world.getMapSize() - 1, 2 };
+			world.placeGenerator(pos);
+			reference.placeGenerator(pos);
+		}
+		world.update();
+		reference.update();
+		if (world.getChecksum() != reference.getChecksum()) {
+			cout << "verify: diverged from the single-threaded reference at tick " << world.getTick() << "\n";
+			return false;
+		}
+	}
+	cout << "verify: " << ticks << " ticks match the single-threaded reference, checksum "
+		<< std::hex << world.getChecksum() << std::dec << "\n";
+	return true;
+}
+
+int main(int argc, char** argv) {
+	vector<string> args(argv + 1, argv + argc);
+	bool verifyRun = std::erase(args, "--verify") > 0;
+	int ticks   = args.size() > 0 ? std::stoi(args[0]) : 10000;
+	int mapSize = args.size() > 1 ? std::stoi(args[1]) : 16;
+	int viewSize = args.size() > 2 ? std::stoi(args[2]) : mapSize;
+
+	tx::JsonObject cfg;
+	initJsonObject("./config/config.json", cfg);
+
+	tx::Time::Timer timer;
+	World world{ cfg, mapSize };
+	buildBenchmarkLayout(world);
+	world.setViewport({ 0, 0 }, { viewSize - 1, viewSize - 1 });
+	cout << "world " << mapSize << "x" << mapSize << ": " << world.getOres().size() << " ore tiles, "
+		<< world.getExtractors().size() << " extractors, " << world.getConveyors().size() << " belts, built in "
+		<< timer.duration() << " ms\n";
+	world.analyzeThroughput().print(cout);
+	cout << "seed " << world.getSeed() << "\n";
+	if (verifyRun) return verify(cfg, world, ticks, viewSize) ? 0 : 1;
+
+	timer.reset();
+	for (int i = 0; i < ticks; ++i) {
+		world.update();
+	}
+	double elapsed = timer.duration();
+	cout << ticks << " ticks in " << elapsed << " ms (" << elapsed * 1000.0 / std::max(ticks, 1) << " us/tick, "
+		<< ticks * world.getTickTime() * 1000.0 / std::max(elapsed, 1e-9) << "x realtime)\n";
+	const std::deque<World::Statistics>& statistics = world.getStatistics();
+	if (statistics.size() >= 2) {
+		float seconds = (statistics.back().tick - statistics.front().tick) * world.getTickTime();
+		cout << "statistics: " << statistics.back().storedItems << " items stored, "
+			<< (statistics.back().storedItems - statistics.front().storedItems) / seconds << " items/s over the last "
+			<< seconds << " s, " << statistics.back().beltItems << " on belts\n";
+	}
+	world.getTickGraph().print(cout);
+	return 0;
+}
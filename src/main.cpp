@@ -10,11 +10,11 @@ class Application {
 	};
 	struct RenderFunc {
 		Application* ptr;
-		inline void operator()() {
-			ptr->render();
+		inline void operator()(float alpha) {
+			ptr->render(alpha);
 		}
 	};
-	tx::RE::Framework<tx::RE::Mode::Release, UpdateFunc, RenderFunc> Framework{UpdateFunc{this}, RenderFunc{this}, 
+	tx::RE::Framework<tx::RE::Mode::Threaded, UpdateFunc, RenderFunc> Framework{UpdateFunc{this}, RenderFunc{this}, 
 	tx::RE::InitGLFW{tx::Coord{1500, 1500}, {}, {}}	
 };
 
@@ -26,11 +26,14 @@ class Application {
   public:
 	Application() {
 		GLFWwindow* window = Framework.getWindow();
+		Framework.setFixedTickrate(game.getTickRate());
 		tx::glfwSetKeyCallback<Application, &Application::onKeyEvent>(Framework.getWindow(), this);
 		
 		glfwSetWindowUserPointer(window, this); 
+		glfwGetWindowSize(window, &windowWidth, &windowHeight);
         glfwSetMouseButtonCallback(window, &Application::onMouseButton);
         glfwSetCursorPosCallback(window, &Application::onMouseMove);
+		glfwSetWindowSizeCallback(window, &Application::onWindowSize);
 		
 		tx::glEnableTransparent();
 	}
@@ -39,56 +42,51 @@ class Application {
 	}
 
   private:
+	// GLFW callbacks only queue their events, the simulation thread handles them (Game::input)
 	void onKeyEvent(GLFWwindow* window, int key, int scancode, int action, int mods) {
-		if (action == GLFW_PRESS) {
-			switch (key) {
-				case GLFW_KEY_1:
-					game.setPlacementMode(0);  // Conveyor mode
-					break;
-				case GLFW_KEY_2:
-					game.setPlacementMode(1);  // Extractor mode
-					break;
-			}
+		if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+			// time warp: the framework runs ticks back to back, for fast forwarding a factory
+			bool warp = !Framework.getTimeWarp();
+			Framework.setTimeWarp(warp);
+			game.setTimeWarp(warp);
+			cout << "[Status]: Time warp " << (warp ? "on" : "off") << "\n";
+			return;
 		}
+		game.input({ InputEvent::Type::Key, key, action });
 	}
 
 	static void onMouseButton(GLFWwindow* window, int button, int action, int mods) {
-        // Get the "Application" instance from the window
-        Application* app = (Application*)glfwGetWindowUserPointer(window);
-        
-        if (app && button == GLFW_MOUSE_BUTTON_LEFT) {
-            double x, y;
-            glfwGetCursorPos(window, &x, &y);
-            
-            int w, h;
-            glfwGetWindowSize(window, &w, &h);
-            
-            // Send to Game: isDown = Press, isRelease = Release
-            app->game.onMouseEvent((float)x, (float)y, (action == GLFW_PRESS), (action == GLFW_RELEASE), w, h);
-        }
-    }
+		Application* app = (Application*)glfwGetWindowUserPointer(window);
+		if (!app) return;
+		double x, y;
+		glfwGetCursorPos(window, &x, &y);
+		app->game.input({ InputEvent::Type::MouseButton, button, action, (float)x, (float)y, app->windowWidth, app->windowHeight });
+	}
 
-    static void onMouseMove(GLFWwindow* window, double x, double y) {
-        Application* app = (Application*)glfwGetWindowUserPointer(window);
-        if (app) {
-            int w, h;
-            glfwGetWindowSize(window, &w, &h);
-            
-            // Send movement updates (isDown and isRelease are false here)
-            app->game.onMouseEvent((float)x, (float)y, false, false, w, h);
-        }
-    }
+	static void onMouseMove(GLFWwindow* window, double x, double y) {
+		Application* app = (Application*)glfwGetWindowUserPointer(window);
+		if (!app) return;
+		app->game.input({ InputEvent::Type::CursorMove, 0, 0, (float)x, (float)y, app->windowWidth, app->windowHeight });
+	}
+
+	static void onWindowSize(GLFWwindow* window, int width, int height) {
+		Application* app = (Application*)glfwGetWindowUserPointer(window);
+		if (!app) return;
+		app->windowWidth = width;
+		app->windowHeight = height;
+	}
 
   private:
-	Game game;
+	Game game{ Framework.getBackground() };
+	int windowWidth = 1, windowHeight = 1;  // cached for the cursor callbacks
 
 
 	void update() {
 		game.update();
 	}
-	void render() {
+	void render(float alpha) {
 		//tx::Time::Timer timer;
-		game.render();
+		game.render(alpha);
 		//cout << timer.duration() << "ms" << endl;
 	}
 };